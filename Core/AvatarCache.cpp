@@ -0,0 +1,210 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "AvatarCache.h"
+#include "FunctionRunnable.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+#include <functional>
+
+CAvatarCache::CAvatarCache( const QString &cacheDir, QObject *parent ) :
+    QObject( parent ),
+    fCacheDir( cacheDir ),
+    fDecodePool( std::make_unique< QThreadPool >() )
+{
+    if ( fCacheDir.isEmpty() )
+        fCacheDir = QDir( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) ).absoluteFilePath( "Avatars" );
+    fDecodePool->setMaxThreadCount( 2 );
+
+    auto cacheDir = fCacheDir;
+    fDecodePool->start( new CFunctionRunnable( [ cacheDir ]() { prune( cacheDir ); } ) );
+}
+
+// a changed avatar gets a new tag and so a new file, the file of the old tag is never read again
+// every read touches the file, anything unread for kMaxUnusedDays belongs to a tag that is gone
+void CAvatarCache::prune( const QString &cacheDir )
+{
+    const int kMaxUnusedDays = 30;
+    auto oldest = QDateTime::currentDateTime().addDays( -kMaxUnusedDays );
+    for ( auto &&ii : QDir( cacheDir ).entryInfoList( { "*.img" }, QDir::Files ) )
+    {
+        if ( ii.lastModified() < oldest )
+            QFile::remove( ii.absoluteFilePath() );
+    }
+}
+
+CAvatarCache::~CAvatarCache()
+{
+    fDecodePool->waitForDone();
+}
+
+QString CAvatarCache::key( const QString &serverName, const QString &imageTag ) const
+{
+    return QString( "%1/%2" ).arg( serverName ).arg( imageTag );
+}
+
+QString CAvatarCache::fileName( const QString &key ) const
+{
+    auto hash = QCryptographicHash::hash( key.toUtf8(), QCryptographicHash::Md5 ).toHex();
+    return QDir( fCacheDir ).absoluteFilePath( QString::fromLatin1( hash ) + ".img" );
+}
+
+QByteArray CAvatarCache::contentHash( const QImage &image )
+{
+    if ( image.isNull() )
+        return {};
+
+    auto argb = image.convertToFormat( QImage::Format_ARGB32 );
+    QCryptographicHash hash( QCryptographicHash::Md5 );
+    hash.addData( QString( "%1x%2" ).arg( argb.width() ).arg( argb.height() ).toLatin1() );
+    // only the pixels of a scan line, the padding at its end is undefined
+    for ( int ii = 0; ii < argb.height(); ++ii )
+        hash.addData( reinterpret_cast< const char * >( argb.constScanLine( ii ) ), argb.width() * 4 );
+    return hash.result();
+}
+
+bool CAvatarCache::load( const QString &serverName, const QString &userID, const QString &imageTag )
+{
+    if ( imageTag.isEmpty() )
+        return false;
+
+    auto key = this->key( serverName, imageTag );
+    auto pos = fAvatars.find( key );
+    if ( pos != fAvatars.end() )
+    {
+        emit sigAvatarLoaded( serverName, userID, ( *pos ).second.fImage, ( *pos ).second.fHash );
+        return true;
+    }
+
+    // already being decoded, from disk or a download
+    auto pos2 = fWaiting.find( key );
+    if ( pos2 != fWaiting.end() )
+    {
+        ( *pos2 ).second.emplace_back( serverName, userID );
+        return true;
+    }
+
+    auto fileName = this->fileName( key );
+    if ( !QFile::exists( fileName ) )
+        return false;
+
+    fWaiting[ key ].emplace_back( serverName, userID );
+    decode( key, {}, fileName, true );
+    return true;
+}
+
+void CAvatarCache::add( const QString &serverName, const QString &userID, const QString &imageTag, const QByteArray &data )
+{
+    if ( imageTag.isEmpty() )
+    {
+        // never looked up, so the users of a tag never wait on it
+        auto key = QString( "\n%1/%2" ).arg( serverName ).arg( userID );
+        fWaiting[ key ].emplace_back( serverName, userID );
+        decode( key, data, {}, false );
+        return;
+    }
+
+    auto key = this->key( serverName, imageTag );
+    auto &&waiting = fWaiting[ key ];
+    auto isDecoding = !waiting.empty();
+    waiting.emplace_back( serverName, userID );
+    if ( !isDecoding )
+        decode( key, data, fileName( key ), false );
+}
+
+void CAvatarCache::decode( const QString &key, const QByteArray &data, const QString &fileName, bool readFile )
+{
+    auto cacheDir = fCacheDir;
+    auto cache = !fileName.isEmpty();
+    fDecodePool->start( new CFunctionRunnable(
+        [ this, key, data, fileName, readFile, cacheDir, cache ]()
+        {
+            auto imageData = data;
+            if ( readFile )
+            {
+                QFile file( fileName );
+                if ( file.open( QFile::ReadWrite ) )   // writable so the modification time can be set
+                {
+                    imageData = file.readAll();
+                    file.setFileTime( QDateTime::currentDateTime(), QFileDevice::FileModificationTime );   // keeps prune from removing it
+                }
+            }
+
+            SAvatar avatar;
+            avatar.fImage = QImage::fromData( imageData );
+            avatar.fHash = contentHash( avatar.fImage );
+
+            if ( cache )
+            {
+                if ( avatar.fImage.isNull() )
+                    QFile::remove( fileName );   // a broken file is downloaded again on the next load
+                else if ( !readFile && QDir().mkpath( cacheDir ) )
+                {
+                    QSaveFile file( fileName );
+                    if ( file.open( QFile::WriteOnly | QFile::Truncate ) )
+                    {
+                        file.write( imageData );
+                        file.commit();
+                    }
+                }
+            }
+
+            QMetaObject::invokeMethod( this, [ this, key, avatar, cache, readFile ]() { decoded( key, avatar, cache, readFile ); }, Qt::QueuedConnection );
+        } ) );
+}
+
+void CAvatarCache::decoded( const QString &key, const SAvatar &avatar, bool cache, bool readFile )
+{
+    if ( cache && !avatar.fImage.isNull() )
+        fAvatars[ key ] = avatar;
+
+    auto pos = fWaiting.find( key );
+    if ( pos == fWaiting.end() )
+        return;
+
+    auto waiting = std::move( ( *pos ).second );
+    fWaiting.erase( pos );
+    if ( avatar.fImage.isNull() )
+    {
+        if ( readFile )
+        {
+            for ( auto &&ii : waiting )
+                emit sigAvatarMissing( ii.first, ii.second );
+        }
+        return;
+    }
+
+    for ( auto &&ii : waiting )
+        emit sigAvatarLoaded( ii.first, ii.second, avatar.fImage, avatar.fHash );
+}
+
+void CAvatarCache::clear()
+{
+    fAvatars.clear();
+}
@@ -0,0 +1,82 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __AVATARCACHE_H
+#define __AVATARCACHE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QImage>
+#include <QString>
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class QThreadPool;
+
+// user avatars by the image tag of the server, a tag names one image so each image is only downloaded once
+// the downloaded bytes are kept on disk between runs, decoding and the content hash run on a worker thread
+class CAvatarCache : public QObject
+{
+    Q_OBJECT
+public:
+    CAvatarCache( const QString &cacheDir = QString(), QObject *parent = nullptr );   // empty uses the standard cache location
+    ~CAvatarCache();
+
+    // true when the image is in memory or on disk and sigAvatarLoaded will follow, false means it has to be downloaded
+    bool load( const QString &serverName, const QString &userID, const QString &imageTag );
+
+    // a downloaded image, an empty tag decodes it without caching, eg right after the avatar was changed on the server
+    void add( const QString &serverName, const QString &userID, const QString &imageTag, const QByteArray &data );
+
+    void clear();   // releases the decoded images, the files are kept
+
+    static QByteArray contentHash( const QImage &image );   // of the pixels, the same image encoded differently has the same hash
+
+Q_SIGNALS:
+    void sigAvatarLoaded( const QString &serverName, const QString &userID, const QImage &image, const QByteArray &hash );
+    void sigAvatarMissing( const QString &serverName, const QString &userID );   // the file on disk could not be decoded, it has been removed
+
+private:
+    struct SAvatar
+    {
+        QImage fImage;
+        QByteArray fHash;
+    };
+    using TWaiting = std::vector< std::pair< QString, QString > >;   // ( server name, user ID )
+
+    static void prune( const QString &cacheDir );   // removes the files no load has read for a while, runs on the decode pool
+    QString key( const QString &serverName, const QString &imageTag ) const;
+    QString fileName( const QString &key ) const;
+
+    // reads the file when data is empty, otherwise writes data to it when fileName is set
+    void decode( const QString &key, const QByteArray &data, const QString &fileName, bool readFile );
+    void decoded( const QString &key, const SAvatar &avatar, bool cache, bool readFile );
+
+    QString fCacheDir;
+    std::unordered_map< QString, SAvatar > fAvatars;   // key -> decoded image
+    std::unordered_map< QString, TWaiting > fWaiting;   // key -> the users waiting on its decode
+    std::unique_ptr< QThreadPool > fDecodePool;
+};
+#endif
@@ -1,16 +1,43 @@
 #include "CollectionsModel.h"
+#include "FunctionRunnable.h"
 #include "MediaData.h"
 #include "MediaModel.h"
+#include "MediaNameIndex.h"
 
 #include <QInputDialog>
 #include <QDebug>
+#include <QThreadPool>
+
+#include <atomic>
+
+struct SResolveMediaJob
+{
+    std::shared_ptr< const CMediaNameIndex > fIndex;
+    std::vector< std::shared_ptr< SMediaCollectionData > > fItems;
+    std::vector< std::shared_ptr< CMediaData > > fMissing;   // the stub each item held when the pass started
+    std::vector< std::shared_ptr< CMediaData > > fResults;
+    std::atomic< int > fNextItem{ 0 };
+    std::atomic< int > fRunning{ 0 };
+};
+
+namespace
+{
+    const int kResolveChunkSize = 16;
+}
 
 CCollectionsModel::CCollectionsModel( std::shared_ptr< CMediaModel > mediaModel ) :
     QAbstractItemModel( nullptr ),
-    fMediaModel( mediaModel )
+    fMediaModel( mediaModel ),
+    fResolvePool( std::make_unique< QThreadPool >() )
 {
 }
 
+// a running pass only posts its results to this object, once the workers are done it is safe to go
+CCollectionsModel::~CCollectionsModel()
+{
+    fResolvePool->waitForDone();
+}
+
 SIndexPtr *CCollectionsModel::idxPtr( void *ptr, bool isCollection ) const
 {
     auto pos = fIndexPtrs.find( ptr );
@@ -164,14 +191,89 @@ void CCollectionsModel::createCollections( std::shared_ptr< const CServerInfo >
 
 void CCollectionsModel::slotMediaModelDataChanged()
 {
+    resolveMissingMedia();
+}
+
+void CCollectionsModel::resolveMissingMedia()
+{
+    if ( fResolving )
+    {
+        fResolvePending = true;
+        return;
+    }
+
+    auto job = std::make_shared< SResolveMediaJob >();
+    for ( auto &&collection : fCollections )
+    {
+        for ( int ii = 0; ii < collection->childCount(); ++ii )
+        {
+            auto item = collection->child( ii );
+            if ( !item || !item->fData || item->fData->onServer() )
+                continue;
+            job->fItems.push_back( item );
+            job->fMissing.push_back( item->fData );
+        }
+    }
+    if ( job->fItems.empty() )
+        return;
+
+    auto snapshot = fMediaModel->nameIndexSnapshot();
+    job->fResults.resize( job->fItems.size() );
+
+    auto count = static_cast< int >( job->fItems.size() );
+    auto numWorkers = std::min( fResolvePool->maxThreadCount(), ( count + kResolveChunkSize - 1 ) / kResolveChunkSize );
+    job->fRunning = numWorkers;
+    fResolving = true;
+
+    // the first worker brings the snapshot up to date before the others are started
+    fResolvePool->start( new CFunctionRunnable(
+        [ this, job, snapshot, numWorkers ]() mutable
+        {
+            job->fIndex = snapshot();
+            snapshot = {};
+            for ( int ii = 1; ii < numWorkers; ++ii )
+                fResolvePool->start( new CFunctionRunnable( [ this, job ]() { resolveChunks( job ); } ) );
+            resolveChunks( job );
+        } ) );
+}
+
+void CCollectionsModel::resolveChunks( const std::shared_ptr< SResolveMediaJob > &job )
+{
+    auto count = static_cast< int >( job->fItems.size() );
+    for ( auto begin = job->fNextItem.fetch_add( kResolveChunkSize ); begin < count; begin = job->fNextItem.fetch_add( kResolveChunkSize ) )
+    {
+        auto end = std::min( begin + kResolveChunkSize, count );
+        for ( auto ii = begin; ii < end; ++ii )
+            job->fResults[ ii ] = job->fIndex->findMatch( job->fMissing[ ii ]->name(), job->fMissing[ ii ]->premiereDate().year(), 3 );
+    }
+    if ( --job->fRunning == 0 )
+        QMetaObject::invokeMethod( this, [ this, job ]() { applyResolvedMedia( job ); }, Qt::QueuedConnection );
+}
+
+void CCollectionsModel::applyResolvedMedia( const std::shared_ptr< SResolveMediaJob > &job )
+{
+    fResolving = false;
+    job->fIndex.reset();   // the next snapshot can only replay the changes onto the copy once nothing reads it
+
     bool changed = false;
-    for ( auto &&ii : fCollections )
-        changed = ii->updateMedia( fMediaModel ) || changed;
+    for ( size_t ii = 0; ii < job->fItems.size(); ++ii )
+    {
+        if ( !job->fResults[ ii ] || ( job->fItems[ ii ]->fData != job->fMissing[ ii ] ) )   // no match, or the item changed while the pass ran
+            continue;
+        job->fItems[ ii ]->fData = job->fResults[ ii ];
+        changed = true;
+    }
     if ( changed )
     {
         beginResetModel();
         endResetModel();
     }
+
+    if ( fResolvePending )
+    {
+        fResolvePending = false;
+        resolveMissingMedia();
+    }
 }
 
 int CCollectionsModel::columnCount( const QModelIndex &parent /*= QModelIndex()*/ ) const
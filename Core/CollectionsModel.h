@@ -10,6 +10,8 @@ struct SMediaCollectionData;
 class CSyncSystem;
 class CServerInfo;
 class CMediaData;
+class QThreadPool;
+struct SResolveMediaJob;
 class CMediaModel;
 
 struct SIndexPtr
@@ -25,6 +27,7 @@ class CCollectionsModel : public QAbstractItemModel
 
 public:
     CCollectionsModel( std::shared_ptr< CMediaModel > mediaModel );
+    ~CCollectionsModel();
 
     virtual QModelIndex index( int row, int column, const QModelIndex &parent = QModelIndex() ) const override;
     virtual QModelIndex parent( const QModelIndex &child ) const override;
@@ -52,6 +55,10 @@ public:
 
     void updateCollections( const QString &serverName, std::shared_ptr< CMediaModel > model );
     void createCollections( std::shared_ptr< const CServerInfo > serverInfo, std::shared_ptr< CSyncSystem > syncSystem, QWidget *parent );
+
+    // matches the missing movies of every collection against a snapshot of the media name index on worker threads
+    // the matches are applied in one batch on the UI thread, a call while a pass is running queues one more pass
+    void resolveMissingMedia();
 public Q_SLOTS:
     void slotMediaModelDataChanged();
 
@@ -59,12 +66,18 @@ private:
     SIndexPtr *idxPtr( CMediaCollection *mediaCollection ) const;
     SIndexPtr *idxPtr( SMediaCollectionData *media ) const;
     SIndexPtr *idxPtr( void *media, bool isCollection ) const;
+    void resolveChunks( const std::shared_ptr< SResolveMediaJob > &job );   // run by every worker of a pass
+    void applyResolvedMedia( const std::shared_ptr< SResolveMediaJob > &job );
 
     std::vector< std::shared_ptr< CMediaCollection > > fCollections;
     std::map< QString, std::vector< std::shared_ptr< CMediaCollection > > > fCollectionsMap;
     mutable std::map< void *, SIndexPtr * > fIndexPtrs;
 
     std::shared_ptr< CMediaModel > fMediaModel;
+
+    std::unique_ptr< QThreadPool > fResolvePool;
+    bool fResolving{ false };
+    bool fResolvePending{ false };
 };
 
 class CCollectionsFilterModel : public QSortFilterProxyModel
@@ -0,0 +1,143 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "LibraryStructure.h"
+
+namespace
+{
+    // only the fields CMediaData reads, the servers return far more than that for every item
+    QJsonObject structureItem( const QJsonObject &item )
+    {
+        static const QStringList kFields{ "Id", "Name", "Type", "OriginalTitle", "IsMissing", "Path", "SeriesName", "SeasonName", "ParentIndexNumber", "IndexNumber", "EpisodeTitle", "ExternalUrls", "ProviderIds", "PremiereDate", "ProductionYear" };
+
+        QJsonObject retVal;
+        for ( auto &&ii : kFields )
+        {
+            auto pos = item.find( ii );
+            if ( pos != item.end() )
+                retVal.insert( ii, pos.value() );
+        }
+
+        // the resolution comes from the video streams, the rest of the media sources is dropped
+        if ( item.contains( "MediaSources" ) )
+        {
+            QJsonArray videoStreams;
+            for ( auto &&ii : item[ "MediaSources" ].toArray() )
+            {
+                for ( auto &&jj : ii.toObject()[ "MediaStreams" ].toArray() )
+                {
+                    auto stream = jj.toObject();
+                    if ( stream[ "Type" ].toString().toLower() != "video" )
+                        continue;
+                    videoStreams.append( QJsonObject( { { "Type", stream[ "Type" ] }, { "Width", stream[ "Width" ] }, { "Height", stream[ "Height" ] } } ) );
+                }
+            }
+            retVal.insert( "MediaSources", QJsonArray( { QJsonObject( { { "MediaStreams", videoStreams } } ) } ) );
+        }
+        return retVal;
+    }
+}
+
+CLibraryStructure::CLibraryStructure( QObject *parent ) :
+    QObject( parent )
+{
+}
+
+CLibraryStructure::EState CLibraryStructure::state( const QString &serverName ) const
+{
+    auto pos = fServers.find( serverName );
+    if ( pos == fServers.end() )
+        return EState::eNotLoaded;
+    return ( *pos ).second.fState;
+}
+
+bool CLibraryStructure::startLoad( const QString &serverName )
+{
+    auto &&server = fServers[ serverName ];
+    if ( server.fState != EState::eNotLoaded )
+        return false;
+    server.fState = EState::eLoading;
+    return true;
+}
+
+void CLibraryStructure::finishLoad( const QString &serverName, bool aOK )
+{
+    auto pos = fServers.find( serverName );
+    if ( ( pos == fServers.end() ) || ( ( *pos ).second.fState != EState::eLoading ) )
+        return;
+
+    if ( aOK )
+        ( *pos ).second.fState = EState::eLoaded;
+    else
+        fServers.erase( pos );
+    emit sigLoadFinished( serverName, aOK );
+}
+
+void CLibraryStructure::addItems( const QString &serverName, const QJsonArray &items )
+{
+    auto &&server = fServers[ serverName ];
+    server.fItems.reserve( server.fItems.size() + items.count() );
+    for ( auto &&ii : items )
+    {
+        auto item = ii.toObject();
+        auto id = item[ "Id" ].toString();
+        if ( id.isEmpty() )
+            continue;
+        server.fItems[ id ] = structureItem( item );
+    }
+}
+
+QJsonArray CLibraryStructure::applyUserData( const QString &serverName, const QJsonArray &userDataItems, QStringList &missingIDs ) const
+{
+    QJsonArray retVal;
+    auto pos = fServers.find( serverName );
+    for ( auto &&ii : userDataItems )
+    {
+        auto userDataItem = ii.toObject();
+        auto id = userDataItem[ "Id" ].toString();
+        if ( pos == fServers.end() )
+        {
+            missingIDs << id;
+            continue;
+        }
+
+        auto itemPos = ( *pos ).second.fItems.find( id );
+        if ( itemPos == ( *pos ).second.fItems.end() )
+        {
+            missingIDs << id;
+            continue;
+        }
+
+        auto item = ( *itemPos ).second;
+        item[ "UserData" ] = userDataItem[ "UserData" ];
+        retVal.append( item );
+    }
+    return retVal;
+}
+
+int CLibraryStructure::itemCount( const QString &serverName ) const
+{
+    auto pos = fServers.find( serverName );
+    if ( pos == fServers.end() )
+        return 0;
+    return static_cast< int >( ( *pos ).second.fItems.size() );
+}
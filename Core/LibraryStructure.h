@@ -0,0 +1,72 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __LIBRARYSTRUCTURE_H
+#define __LIBRARYSTRUCTURE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <map>
+#include <unordered_map>
+
+// the item metadata (paths, provider IDs, external urls, media sources) of each server, shared by every user synced in a run
+// the first user loads the full items, later users only request the play state and it is applied on top of the shared items
+class CLibraryStructure : public QObject
+{
+    Q_OBJECT
+public:
+    enum class EState
+    {
+        eNotLoaded,
+        eLoading,
+        eLoaded
+    };
+
+    CLibraryStructure( QObject *parent = nullptr );
+
+    EState state( const QString &serverName ) const;
+    bool startLoad( const QString &serverName );   // true when the caller should load the full items, false when it is already loading or loaded
+    void finishLoad( const QString &serverName, bool aOK );   // a failed load lets the next user try again
+
+    void addItems( const QString &serverName, const QJsonArray &items );   // only the fields the media model reads are kept, the user data is dropped, items are replaced by ID
+
+    // the full items for the play state items, in the same order, IDs not in the structure are returned in missingIDs
+    QJsonArray applyUserData( const QString &serverName, const QJsonArray &userDataItems, QStringList &missingIDs ) const;
+
+    int itemCount( const QString &serverName ) const;
+
+Q_SIGNALS:
+    void sigLoadFinished( const QString &serverName, bool aOK );
+
+private:
+    struct SServerStructure
+    {
+        EState fState{ EState::eNotLoaded };
+        std::unordered_map< QString, QJsonObject > fItems;   // item ID -> the item fields the media model reads, without UserData
+    };
+    std::map< QString, SServerStructure > fServers;
+};
+#endif
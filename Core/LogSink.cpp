@@ -0,0 +1,173 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "LogSink.h"
+#include "Logging.h"
+#include "SyncSystem.h"
+#include "FunctionRunnable.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace
+{
+    void writeLog( const QString &fileName, qint64 maxBytes, int numBackups, const QStringList &messages )
+    {
+        if ( ( maxBytes > 0 ) && ( QFileInfo( fileName ).size() >= maxBytes ) )
+            CLogSink::rotate( fileName, numBackups );
+
+        QFile fi( fileName );
+        if ( !fi.open( QFile::WriteOnly | QFile::Append | QFile::Text ) )
+            return;
+        fi.write( ( messages.join( '\n' ) + '\n' ).toUtf8() );
+    }
+}
+
+CLogSink::CLogSink( QObject *parent ) :
+    QObject( parent ),
+    fMinLevel( EMsgType::eInfo ),
+    fFileWriter( std::make_unique< QThreadPool >() )
+{
+    fFileWriter->setMaxThreadCount( 1 );
+
+    fFlushTimer = new QTimer( this );
+    fFlushTimer->setSingleShot( true );
+    fFlushTimer->setInterval( 50 );
+    connect( fFlushTimer, &QTimer::timeout, this, &CLogSink::slotFlush );
+}
+
+// the receivers of the display signals may already be gone, only the file is flushed
+CLogSink::~CLogSink()
+{
+    flushFile();
+    fFileWriter->waitForDone();
+}
+
+bool CLogSink::passes( int msgType ) const
+{
+    return msgType <= fMinLevel;
+}
+
+void CLogSink::addMessage( int msgType, const QString &msg )
+{
+    auto fullMsg = createMessage( static_cast< EMsgType >( msgType ), msg );
+    qCInfo( lcLog ).noquote() << fullMsg;
+
+    fEntries.push_back( { msgType, fullMsg } );
+    while ( static_cast< int >( fEntries.size() ) > fMaxEntries )
+        fEntries.pop_front();
+
+    if ( !fFileName.isEmpty() )
+        fPendingFile << fullMsg;
+    if ( passes( msgType ) )
+        fPending << fullMsg;
+
+    // started only when idle, so a steady stream of messages is still shown every interval
+    if ( ( !fPending.isEmpty() || !fPendingFile.isEmpty() ) && !fFlushTimer->isActive() )
+        fFlushTimer->start();
+}
+
+void CLogSink::flushFile()
+{
+    if ( fPendingFile.isEmpty() )
+        return;
+
+    fFileWriter->start( new CFunctionRunnable( [ fileName = fFileName, maxBytes = fMaxFileBytes, numBackups = fNumBackups, messages = fPendingFile ]() { writeLog( fileName, maxBytes, numBackups, messages ); } ) );
+    fPendingFile.clear();
+}
+
+void CLogSink::slotFlush()
+{
+    flushFile();
+
+    if ( fPending.isEmpty() )
+        return;
+
+    // a burst larger than the buffer only shows its tail
+    if ( fPending.count() > fMaxEntries )
+        fPending = fPending.mid( fPending.count() - fMaxEntries );
+
+    auto lastMessage = fPending.back();
+    emit sigAppend( fPending );
+    emit sigLastMessage( lastMessage );
+    fPending.clear();
+}
+
+void CLogSink::setMaxEntries( int maxEntries )
+{
+    fMaxEntries = std::max( 1, maxEntries );
+    while ( static_cast< int >( fEntries.size() ) > fMaxEntries )
+        fEntries.pop_front();
+}
+
+void CLogSink::setMinLevel( int minLevel )
+{
+    if ( minLevel == fMinLevel )
+        return;
+
+    fMinLevel = minLevel;
+    fPending.clear();
+    emit sigReset( messages() );
+}
+
+void CLogSink::setLogFile( const QString &fileName, qint64 maxBytes, int numBackups )
+{
+    flushFile();   // what is pending belongs to the old file
+    fFileName = fileName;
+    fMaxFileBytes = maxBytes;
+    fNumBackups = numBackups;
+}
+
+void CLogSink::clear()
+{
+    fEntries.clear();
+    fPending.clear();
+}
+
+QStringList CLogSink::messages() const
+{
+    QStringList retVal;
+    for ( auto &&ii : fEntries )
+    {
+        if ( passes( ii.fType ) )
+            retVal << ii.fMessage;
+    }
+    return retVal;
+}
+
+void CLogSink::rotate( const QString &fileName, int numBackups )
+{
+    if ( numBackups <= 0 )
+    {
+        QFile::remove( fileName );
+        return;
+    }
+
+    QFile::remove( QString( "%1.%2" ).arg( fileName ).arg( numBackups ) );
+    for ( int ii = numBackups - 1; ii >= 1; --ii )
+        QFile::rename( QString( "%1.%2" ).arg( fileName ).arg( ii ), QString( "%1.%2" ).arg( fileName ).arg( ii + 1 ) );
+    QFile::rename( fileName, QString( "%1.1" ).arg( fileName ) );
+}
@@ -0,0 +1,92 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __LOGSINK_H
+#define __LOGSINK_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <deque>
+#include <memory>
+
+class QTimer;
+class QThreadPool;
+
+// collects log messages for a log pane
+// the last maxEntries messages are kept in a ring buffer, the ones at or above the minimum level are handed out in one
+// sigAppend per flush interval, and every message can be appended to a file on a background thread, rotated by size
+class CLogSink : public QObject
+{
+    Q_OBJECT
+public:
+    CLogSink( QObject *parent = nullptr );
+    ~CLogSink();
+
+    void addMessage( int msgType, const QString &msg );   // msgType is an EMsgType
+
+    int maxEntries() const { return fMaxEntries; }
+    void setMaxEntries( int maxEntries );
+
+    int minLevel() const { return fMinLevel; }   // the least severe EMsgType shown, eInfo shows everything
+    void setMinLevel( int minLevel );   // sigReset is emitted with the buffered messages that now pass
+
+    // an empty file name turns file logging off, when the file grows past maxBytes it becomes .1, .1 becomes .2 up to numBackups
+    void setLogFile( const QString &fileName, qint64 maxBytes = 10 * 1024 * 1024, int numBackups = 3 );
+
+    void clear();   // drops the buffered and pending messages, the file is left as is
+    QStringList messages() const;   // the buffered messages at or above the minimum level
+
+    static void rotate( const QString &fileName, int numBackups );
+
+Q_SIGNALS:
+    void sigAppend( const QStringList &messages );
+    void sigReset( const QStringList &messages );
+    void sigLastMessage( const QString &message );
+
+private Q_SLOTS:
+    void slotFlush();
+
+private:
+    struct SEntry
+    {
+        int fType;
+        QString fMessage;
+    };
+    bool passes( int msgType ) const;
+    void flushFile();
+
+    std::deque< SEntry > fEntries;
+    int fMaxEntries{ 10000 };
+    int fMinLevel;
+
+    QStringList fPending;
+    QStringList fPendingFile;
+    QTimer *fFlushTimer{ nullptr };
+
+    QString fFileName;
+    qint64 fMaxFileBytes{ 0 };
+    int fNumBackups{ 0 };
+    std::unique_ptr< QThreadPool > fFileWriter;   // a single thread, so the batches reach the file in order
+};
+#endif
@@ -0,0 +1,126 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Logging.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrlQuery>
+
+#include <atomic>
+#include <mutex>
+
+Q_LOGGING_CATEGORY( lcNetwork, "embysync.network", QtInfoMsg )
+Q_LOGGING_CATEGORY( lcSync, "embysync.sync", QtInfoMsg )
+Q_LOGGING_CATEGORY( lcSyncJson, "embysync.sync.json", QtInfoMsg )
+Q_LOGGING_CATEGORY( lcMediaModel, "embysync.mediamodel", QtInfoMsg )
+Q_LOGGING_CATEGORY( lcLog, "embysync.log", QtInfoMsg )
+
+namespace NLogging
+{
+    std::mutex sCaptureMutex;
+    QString sCaptureDir = qEnvironmentVariable( "EMBYSYNC_CAPTURE_DIR" );
+    std::atomic< uint64_t > sCaptureNum{ 0 };
+
+    void setCaptureDir( const QString &dir )
+    {
+        std::lock_guard< std::mutex > lock( sCaptureMutex );
+        sCaptureDir = dir;
+    }
+
+    QString captureDir()
+    {
+        std::lock_guard< std::mutex > lock( sCaptureMutex );
+        return sCaptureDir;
+    }
+
+    bool captureEnabled()
+    {
+        return !captureDir().isEmpty();
+    }
+
+    // the api key is part of every url, it never goes to disk
+    QString redactedUrl( QUrl url )
+    {
+        QUrlQuery query( url );
+        if ( query.hasQueryItem( "api_key" ) )
+        {
+            query.removeAllQueryItems( "api_key" );
+            query.addQueryItem( "api_key", "<redacted>" );
+            url.setQuery( query );
+        }
+        return url.toString();
+    }
+
+    void writeCapture( const QString &requestType, const QString &suffix, const QJsonObject &header, const QByteArray &data )
+    {
+        auto dir = captureDir();
+        if ( dir.isEmpty() || !QDir().mkpath( dir ) )
+            return;
+
+        auto fileName = QDir( dir ).absoluteFilePath( QString( "%1_%2_%3.json" ).arg( ++sCaptureNum, 6, 10, QChar( '0' ) ).arg( requestType ).arg( suffix ) );
+        QFile file( fileName );
+        if ( !file.open( QFile::WriteOnly | QFile::Truncate ) )
+        {
+            qCWarning( lcNetwork ) << "Could not open capture file" << fileName;
+            return;
+        }
+
+        auto root = header;
+        root[ "Time" ] = QDateTime::currentDateTimeUtc().toString( Qt::ISODateWithMs );
+        auto doc = QJsonDocument::fromJson( data );
+        if ( !doc.isNull() )
+            root[ "Body" ] = doc.isArray() ? QJsonValue( doc.array() ) : QJsonValue( doc.object() );
+        else
+            root[ "Body" ] = QString::fromUtf8( data );
+        file.write( QJsonDocument( root ).toJson( QJsonDocument::Indented ) );
+    }
+
+    void captureRequest( const QString &requestType, const QNetworkRequest &request, const QString &method, const QByteArray &data )
+    {
+        if ( !captureEnabled() )
+            return;
+
+        QJsonObject header;
+        header[ "Method" ] = method;
+        header[ "Url" ] = redactedUrl( request.url() );
+        writeCapture( requestType, "request", header, data );
+    }
+
+    void captureResponse( const QString &requestType, QNetworkReply *reply, const QByteArray &data )
+    {
+        if ( !captureEnabled() || !reply )
+            return;
+
+        QJsonObject header;
+        header[ "Url" ] = redactedUrl( reply->url() );
+        header[ "Status" ] = reply->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
+        header[ "Error" ] = reply->errorString();
+        writeCapture( requestType, "response", header, data );
+    }
+}
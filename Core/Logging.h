@@ -0,0 +1,52 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __LOGGING_H
+#define __LOGGING_H
+
+#include <QLoggingCategory>
+#include <QString>
+
+class QByteArray;
+class QNetworkRequest;
+class QNetworkReply;
+
+// per subsystem trace categories, all debug output is off by default
+// enable with QT_LOGGING_RULES, for example QT_LOGGING_RULES="embysync.network.debug=true"
+Q_DECLARE_LOGGING_CATEGORY( lcNetwork )   // embysync.network - request urls and scheduling
+Q_DECLARE_LOGGING_CATEGORY( lcSync )   // embysync.sync - load and sync progress
+Q_DECLARE_LOGGING_CATEGORY( lcSyncJson )   // embysync.sync.json - full json documents, very large
+Q_DECLARE_LOGGING_CATEGORY( lcMediaModel )   // embysync.mediamodel - per item model updates
+Q_DECLARE_LOGGING_CATEGORY( lcLog )   // embysync.log - every message sent to the log pane
+
+namespace NLogging
+{
+    // when set, every request and response is written to its own file in the directory
+    // the EMBYSYNC_CAPTURE_DIR environment variable sets the initial value
+    void setCaptureDir( const QString &dir );
+    QString captureDir();
+    bool captureEnabled();
+
+    void captureRequest( const QString &requestType, const QNetworkRequest &request, const QString &method, const QByteArray &data );
+    void captureResponse( const QString &requestType, QNetworkReply *reply, const QByteArray &data );
+}
+#endif
@@ -0,0 +1,149 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MediaCache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+CMediaCache::CMediaCache( const QString &cacheDir ) :
+    fCacheDir( cacheDir )
+{
+    if ( fCacheDir.isEmpty() )
+        fCacheDir = QDir( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) ).absoluteFilePath( "MediaCache" );
+}
+
+QString CMediaCache::fileName( const QString &serverName, const QString &userID ) const
+{
+    auto key = QCryptographicHash::hash( QString( "%1/%2" ).arg( serverName ).arg( userID ).toUtf8(), QCryptographicHash::Md5 ).toHex();
+    return QDir( fCacheDir ).absoluteFilePath( QString::fromLatin1( key ) + ".json" );
+}
+
+bool CMediaCache::load( const QString &serverName, const QString &userID, const QString &queryKey, int maxAgeDays )
+{
+    fEntries.erase( { serverName, userID } );
+
+    QFile file( fileName( serverName, userID ) );
+    if ( !file.open( QFile::ReadOnly ) )
+        return false;
+
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson( file.readAll(), &error );
+    if ( error.error != QJsonParseError::NoError )
+        return false;
+
+    auto root = doc.object();
+    if ( ( root[ "ServerName" ].toString() != serverName ) || ( root[ "UserID" ].toString() != userID ) || ( root[ "QueryKey" ].toString() != queryKey ) )
+        return false;
+
+    auto lastSync = QDateTime::fromString( root[ "LastSync" ].toString(), Qt::ISODate );
+    if ( !lastSync.isValid() )
+        return false;
+
+    // deleted items never show up in a delta, so the snapshot is periodically rebuilt from scratch
+    if ( ( maxAgeDays > 0 ) && ( lastSync.daysTo( QDateTime::currentDateTimeUtc() ) >= maxAgeDays ) )
+        return false;
+
+    auto &&entry = fEntries[ { serverName, userID } ];
+    entry.fLastSync = lastSync;
+    entry.fQueryKey = queryKey;
+    auto items = root[ "Items" ].toArray();
+    for ( auto &&ii : items )
+    {
+        auto item = ii.toObject();
+        entry.fItems[ item[ "Id" ].toString() ] = item;
+    }
+    return true;
+}
+
+bool CMediaCache::save( const QString &serverName, const QString &userID, const QString &queryKey, const QDateTime &syncTime )
+{
+    auto pos = fEntries.find( { serverName, userID } );
+    if ( pos == fEntries.end() )
+        return false;
+
+    if ( !QDir().mkpath( fCacheDir ) )
+        return false;
+
+    auto &&entry = ( *pos ).second;
+    entry.fLastSync = syncTime.toUTC();
+    entry.fQueryKey = queryKey;
+
+    QJsonArray items;
+    for ( auto &&ii : entry.fItems )
+        items.append( ii.second );
+
+    QJsonObject root;
+    root[ "ServerName" ] = serverName;
+    root[ "UserID" ] = userID;
+    root[ "QueryKey" ] = queryKey;
+    root[ "LastSync" ] = entry.fLastSync.toString( Qt::ISODate );
+    root[ "Items" ] = items;
+
+    QSaveFile file( fileName( serverName, userID ) );
+    if ( !file.open( QFile::WriteOnly | QFile::Truncate ) )
+        return false;
+    file.write( QJsonDocument( root ).toJson( QJsonDocument::Compact ) );
+    return file.commit();
+}
+
+void CMediaCache::reset( const QString &serverName, const QString &userID )
+{
+    fEntries[ { serverName, userID } ] = SMediaCacheEntry();
+}
+
+void CMediaCache::addItems( const QString &serverName, const QString &userID, const QJsonArray &items )
+{
+    auto &&entry = fEntries[ { serverName, userID } ];
+    for ( auto &&ii : items )
+    {
+        auto item = ii.toObject();
+        auto id = item[ "Id" ].toString();
+        if ( id.isEmpty() )
+            continue;
+        entry.fItems[ id ] = item;
+    }
+}
+
+QJsonArray CMediaCache::items( const QString &serverName, const QString &userID ) const
+{
+    QJsonArray retVal;
+    auto pos = fEntries.find( { serverName, userID } );
+    if ( pos == fEntries.end() )
+        return retVal;
+
+    for ( auto &&ii : ( *pos ).second.fItems )
+        retVal.append( ii.second );
+    return retVal;
+}
+
+QDateTime CMediaCache::lastSync( const QString &serverName, const QString &userID ) const
+{
+    auto pos = fEntries.find( { serverName, userID } );
+    if ( pos == fEntries.end() )
+        return {};
+    return ( *pos ).second.fLastSync;
+}
@@ -0,0 +1,66 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MEDIACACHE_H
+#define __MEDIACACHE_H
+
+#include <QString>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include <map>
+#include <utility>
+
+// on disk snapshot of the media items loaded for a user on a server
+// the raw item json from the server is stored, so reloading it goes through the same path as a fresh load
+struct SMediaCacheEntry
+{
+    QDateTime fLastSync;   // UTC time the items were requested
+    QString fQueryKey;   // item types and fields the items were requested with, a mismatch invalidates the cache
+    std::map< QString, QJsonObject > fItems;   // media ID -> item json
+};
+
+class CMediaCache
+{
+public:
+    CMediaCache( const QString &cacheDir = QString() );   // empty uses the standard cache location
+
+    // returns true when there is a usable snapshot on disk, false means a full load is needed
+    bool load( const QString &serverName, const QString &userID, const QString &queryKey, int maxAgeDays );
+    bool save( const QString &serverName, const QString &userID, const QString &queryKey, const QDateTime &syncTime );
+
+    void reset( const QString &serverName, const QString &userID );   // start an empty snapshot for a full load
+    void addItems( const QString &serverName, const QString &userID, const QJsonArray &items );   // adds or replaces by item ID
+
+    QJsonArray items( const QString &serverName, const QString &userID ) const;
+    QDateTime lastSync( const QString &serverName, const QString &userID ) const;
+
+    void clear() { fEntries.clear(); }   // releases the in memory snapshots, the files are kept
+
+private:
+    QString fileName( const QString &serverName, const QString &userID ) const;
+
+    QString fCacheDir;
+    std::map< std::pair< QString, QString >, SMediaCacheEntry > fEntries;   // ( server name, user ID ) -> snapshot
+};
+#endif
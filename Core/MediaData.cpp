@@ -28,7 +28,11 @@
 #include "MediaModel.h"
 #include "SyncSystem.h"
 #include "MovieStub.h"
+#include "StringPool.h"
+#include "TitleNormalizer.h"
+#include "MovieListReader.h"
 #include "SABUtils/StringUtils.h"
+#include "Logging.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -40,6 +44,7 @@
 #include <QDesktopServices>
 #include <chrono>
 #include <optional>
+#include <algorithm>
 #include <QDebug>
 #include <QAction>
 #include <QMenu>
@@ -60,44 +65,56 @@ std::function< QString( uint64_t ) > CMediaData::mecsToStringFunc()
     return sMSecsToStringFunc;
 }
 
-CMediaData::CMediaData( const QJsonObject &mediaObj, std::shared_ptr< CServerModel > serverModel )
+CMediaData::CMediaData( const QJsonObject &mediaObj, std::shared_ptr< CServerModel > serverModel ) :
+    CMediaData( mediaObj, serverModel->enabledServerNames() )
+{
+}
+
+CMediaData::CMediaData( const QJsonObject &mediaObj, const QStringList &serverNames )
 {
     // auto tmp = ;
     // qDebug() << tmp.toJson();
 
     computeName( mediaObj );
     //qDebug().nospace().noquote() << QJsonDocument( mediaObj ).toJson();
-    fType = mediaObj[ "Type" ].toString();
+    fType = CStringPool::intern( mediaObj[ "Type" ].toString() );
     fOriginalTitle = mediaObj[ "OriginalTitle" ].toString();
+    computeNameKeys();
     fIsMissing = mediaObj[ "IsMissing" ].toBool();
 
-    for ( auto &&serverInfo : *serverModel )
-    {
-        if ( !serverInfo->isEnabled() )
-            continue;
-        fInfoForServer[ serverInfo->keyName() ] = std::make_shared< SMediaServerData >();
-    }
+    // size the array once for every registered server, it is never resized so pointers handed out by userMediaData stay valid
+    std::vector< int > serverIndexes;
+    serverIndexes.reserve( serverNames.count() );
+    for ( auto &&serverName : serverNames )
+        serverIndexes.push_back( CServerIndex::index( serverName ) );
+    fInfoForServer.resize( CServerIndex::count() );
+    for ( auto &&ii : serverIndexes )
+        addServerData( ii );
+    updateSyncStatus();
 }
 
 CMediaData::CMediaData( const SMovieStub &movieStub, const QString &type )
 {
     fName = movieStub.fName;
     fOriginalTitle = fName;
-    fType = type;
+    computeNameKeys();
+    fIsMovieStub = true;
+    fType = CStringPool::intern( type );
     fPremiereDate = QDate( movieStub.fYear, 1, 1 );
     if ( movieStub.hasResolution() )
         fResolution = movieStub.fResolution.value();
     else
         fResolution = { 0, 0 };
+    updateSyncStatus();
 }
 
 QString CMediaData::searchKey() const
 {
     QString searchKey;
-    auto pos = fProviders.find( "imdb" );
-    if ( pos != fProviders.end() )
+    auto imdbID = findProvider( "imdb" );
+    if ( imdbID )
     {
-        searchKey = ( *pos ).second;
+        searchKey = *imdbID;
     }
     if ( searchKey.isEmpty() )
         searchKey = QString( R"("%1")" ).arg( fName );
@@ -165,12 +182,37 @@ bool CMediaData::isExtra( const QJsonObject &obj )
     return false;
 }
 
+SMediaServerData *CMediaData::serverData( const QString &serverName )
+{
+    auto index = CServerIndex::find( serverName );
+    if ( ( index < 0 ) || ( index >= static_cast< int >( fInfoForServer.size() ) ) || !fInfoForServer[ index ].has_value() )
+        return nullptr;
+    return &fInfoForServer[ index ].value();
+}
+
+const SMediaServerData *CMediaData::serverData( const QString &serverName ) const
+{
+    return const_cast< CMediaData * >( this )->serverData( serverName );
+}
+
+SMediaServerData *CMediaData::addServerData( int serverIndex )
+{
+    // the servers are registered before any media is loaded, a later one means the models were not reset when it was added
+    Q_ASSERT( ( serverIndex >= 0 ) && ( serverIndex < static_cast< int >( fInfoForServer.size() ) ) );
+    if ( ( serverIndex < 0 ) || ( serverIndex >= static_cast< int >( fInfoForServer.size() ) ) )
+        return nullptr;
+    if ( !fInfoForServer[ serverIndex ].has_value() )
+        fInfoForServer[ serverIndex ].emplace();
+    return &fInfoForServer[ serverIndex ].value();
+}
+
+// the returned pointer shares ownership with this media, callers update the play state through it
 std::shared_ptr< SMediaServerData > CMediaData::userMediaData( const QString &serverName ) const
 {
-    auto pos = fInfoForServer.find( serverName );
-    if ( pos != fInfoForServer.end() )
-        return ( *pos ).second;
-    return {};
+    auto data = const_cast< CMediaData * >( this )->serverData( serverName );
+    if ( !data )
+        return {};
+    return std::shared_ptr< SMediaServerData >( shared_from_this(), data );
 }
 
 QString CMediaData::name() const
@@ -188,6 +230,13 @@ QString CMediaData::mediaType() const
     return fType;
 }
 
+// titles are mostly unique per item, they bypass the shared key cache so loading a library does not flush it
+void CMediaData::computeNameKeys()
+{
+    fNameKey = CTitleNormalizer::normalize( fName );
+    fOriginalTitleKey = ( fOriginalTitle == fName ) ? fNameKey : CTitleNormalizer::normalize( fOriginalTitle );
+}
+
 void CMediaData::computeName( const QJsonObject &media )
 {
     auto name = fName = media[ "Name" ].toString();
@@ -196,7 +245,7 @@ void CMediaData::computeName( const QJsonObject &media )
         // auto tmp = QJsonDocument( media );
         // qDebug() << tmp.toJson();
 
-        fSeriesName = media[ "SeriesName" ].toString();
+        fSeriesName = CStringPool::intern( media[ "SeriesName" ].toString() );
         auto season = media[ "SeasonName" ].toString();
         auto pos = season.lastIndexOf( ' ' );
         bool aOK = false;
@@ -242,7 +291,27 @@ void CMediaData::loadData( const QString &serverName, const QJsonObject &media )
         auto urlObj = ii.toObject();
         auto name = urlObj[ "Name" ].toString();
         auto url = urlObj[ "Url" ].toString();
-        fExternalUrls[ name ] = url;
+
+        // the scheme and host repeat across every item, only the path is unique
+        SExternalUrl externalUrl;
+        externalUrl.fName = CStringPool::intern( name );
+        auto hostStart = url.indexOf( "://" );
+        auto pathStart = ( hostStart == -1 ) ? -1 : url.indexOf( '/', hostStart + 3 );
+        if ( hostStart == -1 )
+            externalUrl.fPath = url;
+        else if ( pathStart == -1 )
+            externalUrl.fHost = CStringPool::intern( url );
+        else
+        {
+            externalUrl.fHost = CStringPool::intern( url.left( pathStart ) );
+            externalUrl.fPath = url.mid( pathStart );
+        }
+
+        auto pos = std::lower_bound( fExternalUrls.begin(), fExternalUrls.end(), name, []( const SExternalUrl &lhs, const QString &rhs ) { return lhs.fName < rhs; } );
+        if ( ( pos != fExternalUrls.end() ) && ( ( *pos ).fName == name ) )
+            *pos = externalUrl;
+        else
+            fExternalUrls.insert( pos, externalUrl );
     }
 
     auto userDataObj = media[ "UserData" ].toObject();
@@ -250,8 +319,12 @@ void CMediaData::loadData( const QString &serverName, const QJsonObject &media )
     // auto tmp = QJsonDocument( userDataObj );
     // qDebug() << tmp.toJson();
 
-    auto mediaData = userMediaData( serverName );
-    mediaData->loadUserDataFromJSON( userDataObj );
+    // a server registered after the item was built has no slot, its play state cannot be kept
+    auto mediaData = serverData( serverName );
+    if ( mediaData )
+        mediaData->loadUserDataFromJSON( userDataObj );
+    else
+        qCWarning( lcMediaModel ).noquote() << "No data for server" << serverName << "on" << name() << "the play state was skipped";
 
     auto providerIDsObj = media[ "ProviderIds" ].toObject();
     for ( auto &&ii = providerIDsObj.begin(); ii != providerIDsObj.end(); ++ii )
@@ -266,6 +339,7 @@ void CMediaData::loadData( const QString &serverName, const QJsonObject &media )
     {
         loadResolution( media[ "MediaSources" ].toArray() );
     }
+    updateSyncStatus();
 }
 
 void CMediaData::loadResolution( const QJsonArray &mediaSources )
@@ -301,13 +375,21 @@ QString CMediaData::externalUrlsText() const
     QStringList externalUrls;
     for ( auto &&ii : fExternalUrls )
     {
-        auto curr = QString( R"(<li>%1 - <a href="%2">%2</a></li>)" ).arg( ii.first ).arg( ii.second );
+        auto curr = QString( R"(<li>%1 - <a href="%2">%2</a></li>)" ).arg( ii.fName ).arg( ii.url() );
         externalUrls << curr;
     }
     retVal = retVal.arg( externalUrls.join( "\n" ) );
     return retVal;
 }
 
+std::map< QString, QString > CMediaData::getExternalUrls() const
+{
+    std::map< QString, QString > retVal;
+    for ( auto &&ii : fExternalUrls )
+        retVal[ ii.fName ] = ii.url();
+    return retVal;
+}
+
 bool CMediaData::hasProviderIDs() const
 {
     return !fProviders.empty();
@@ -325,7 +407,7 @@ QString CMediaData::getProviderList() const
 
 bool CMediaData::isPlayed( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return false;
     return mediaData->fPlayed;
@@ -333,7 +415,7 @@ bool CMediaData::isPlayed( const QString &serverName ) const
 
 uint64_t CMediaData::playCount( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return 0;
     return mediaData->fPlayCount;
@@ -341,12 +423,12 @@ uint64_t CMediaData::playCount( const QString &serverName ) const
 
 bool CMediaData::allPlayCountEqual() const
 {
-    return allEqual< uint64_t >( []( std::shared_ptr< SMediaServerData > data ) { return data->fPlayCount; } );
+    return syncStatusSet( eAllPlayCountEqual );
 }
 
 bool CMediaData::isFavorite( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return false;
     return mediaData->fIsFavorite;
@@ -354,12 +436,12 @@ bool CMediaData::isFavorite( const QString &serverName ) const
 
 bool CMediaData::allFavoriteEqual() const
 {
-    return allEqual< bool >( []( std::shared_ptr< SMediaServerData > data ) { return data->fIsFavorite; } );
+    return syncStatusSet( eAllFavoriteEqual );
 }
 
 QDateTime CMediaData::lastPlayed( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return {};
     return mediaData->fLastPlayedDate;
@@ -367,13 +449,13 @@ QDateTime CMediaData::lastPlayed( const QString &serverName ) const
 
 bool CMediaData::allLastPlayedEqual() const
 {
-    return allEqual< QDateTime >( []( std::shared_ptr< SMediaServerData > data ) { return data->fLastPlayedDate; } );
+    return syncStatusSet( eAllLastPlayedEqual );
 }
 
 // 1 tick = 10000 ms
 uint64_t CMediaData::playbackPositionTicks( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return 0;
     return mediaData->fPlaybackPositionTicks;
@@ -383,7 +465,7 @@ uint64_t CMediaData::playbackPositionTicks( const QString &serverName ) const
 // 1 tick = 10000 ms
 uint64_t CMediaData::playbackPositionMSecs( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return 0;
     return mediaData->playbackPositionMSecs();
@@ -391,7 +473,7 @@ uint64_t CMediaData::playbackPositionMSecs( const QString &serverName ) const
 
 QString CMediaData::playbackPosition( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return {};
     return mediaData->playbackPosition();
@@ -399,7 +481,7 @@ QString CMediaData::playbackPosition( const QString &serverName ) const
 
 QTime CMediaData::playbackPositionTime( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return {};
     return mediaData->playbackPositionTime();
@@ -419,12 +501,12 @@ std::pair< int, int > CMediaData::resolutionValue() const
 
 bool CMediaData::allPlayedEqual() const
 {
-    return allEqual< bool >( []( std::shared_ptr< SMediaServerData > data ) { return data->fPlayed; } );
+    return syncStatusSet( eAllPlayedEqual );
 }
 
 bool CMediaData::allPlaybackPositionTicksEqual() const
 {
-    return allEqual< int64_t >( []( std::shared_ptr< SMediaServerData > data ) { return data->fPlaybackPositionTicks; } );
+    return syncStatusSet( eAllPlaybackPositionTicksEqual );
 }
 
 QUrlQuery CMediaData::getSearchForMediaQuery() const
@@ -440,17 +522,25 @@ QUrlQuery CMediaData::getSearchForMediaQuery() const
     return query;
 }
 
+const QString *CMediaData::findProvider( const QString &providerName ) const
+{
+    auto pos = std::lower_bound( fProviders.begin(), fProviders.end(), providerName, []( const std::pair< QString, QString > &lhs, const QString &rhs ) { return lhs.first < rhs; } );
+    if ( ( pos == fProviders.end() ) || ( ( *pos ).first != providerName ) )
+        return nullptr;
+    return &( *pos ).second;
+}
+
 QString CMediaData::getProviderID( const QString &provider )
 {
-    auto pos = fProviders.find( provider );
-    if ( pos == fProviders.end() )
+    auto providerID = findProvider( provider );
+    if ( !providerID )
         return {};
-    return ( *pos ).second;
+    return *providerID;
 }
 
 std::map< QString, QString > CMediaData::getProviders( bool addKeyIfEmpty /*= false */ ) const
 {
-    auto retVal = fProviders;
+    std::map< QString, QString > retVal( fProviders.begin(), fProviders.end() );
     if ( addKeyIfEmpty && retVal.empty() )
     {
         retVal[ fType ] = fName;
@@ -461,30 +551,69 @@ std::map< QString, QString > CMediaData::getProviders( bool addKeyIfEmpty /*= fa
 
 void CMediaData::addProvider( const QString &providerName, const QString &providerID )
 {
-    fProviders[ providerName ] = providerID;
+    auto pos = std::lower_bound( fProviders.begin(), fProviders.end(), providerName, []( const std::pair< QString, QString > &lhs, const QString &rhs ) { return lhs.first < rhs; } );
+    if ( ( pos != fProviders.end() ) && ( ( *pos ).first == providerName ) )
+        ( *pos ).second = providerID;
+    else
+        fProviders.emplace( pos, CStringPool::intern( providerName ), providerID );
 }
 
 void CMediaData::setMediaID( const QString &serverName, const QString &mediaID )
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
+    if ( !mediaData )
+        return;
     mediaData->fMediaID = mediaID;
-    updateCanBeSynced();
+    updateSyncStatus();
 }
 
-void CMediaData::updateCanBeSynced()
+// one pass over the valid servers, everything the model and filter ask per cell is answered from the result
+void CMediaData::updateSyncStatus()
 {
     int serverCnt = 0;
-    for ( auto &&ii : fInfoForServer )
+    uint8_t status = eValidUserDataEqual | eAllPlayedEqual | eAllFavoriteEqual | eAllLastPlayedEqual | eAllPlayCountEqual | eAllPlaybackPositionTicksEqual;
+    const SMediaServerData *first = nullptr;
+    const SMediaServerData *prev = nullptr;
+    fNewestServer = -1;
+    for ( size_t ii = 0; ii < fInfoForServer.size(); ++ii )
     {
-        if ( ii.second->isValid() )
-            serverCnt++;
+        auto &&curr = fInfoForServer[ ii ];
+        if ( !curr.has_value() || !curr->isValid() )
+            continue;
+
+        serverCnt++;
+        if ( !first )
+        {
+            first = prev = &curr.value();
+            fNewestServer = static_cast< int >( ii );
+            continue;
+        }
+
+        if ( !prev->userDataEqual( curr.value() ) )
+            status &= ~eValidUserDataEqual;
+        if ( first->fPlayed != curr->fPlayed )
+            status &= ~eAllPlayedEqual;
+        if ( first->fIsFavorite != curr->fIsFavorite )
+            status &= ~eAllFavoriteEqual;
+        if ( first->fLastPlayedDate != curr->fLastPlayedDate )
+            status &= ~eAllLastPlayedEqual;
+        if ( first->fPlayCount != curr->fPlayCount )
+            status &= ~eAllPlayCountEqual;
+        if ( first->fPlaybackPositionTicks != curr->fPlaybackPositionTicks )
+            status &= ~eAllPlaybackPositionTicksEqual;
+
+        if ( curr->fLastPlayedDate > fInfoForServer[ fNewestServer ]->fLastPlayedDate )
+            fNewestServer = static_cast< int >( ii );
+        prev = &curr.value();
     }
-    fCanBeSynced = serverCnt > 1;
+    if ( serverCnt > 1 )
+        status |= eCanBeSynced;
+    fSyncStatus = status;
 }
 
 QString CMediaData::getMediaID( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return {};
     return mediaData->fMediaID;
@@ -492,7 +621,7 @@ QString CMediaData::getMediaID( const QString &serverName ) const
 
 bool CMediaData::beenLoaded( const QString &serverName ) const
 {
-    auto mediaData = userMediaData( serverName );
+    auto mediaData = serverData( serverName );
     if ( !mediaData )
         return {};
     return mediaData->fBeenLoaded;
@@ -534,13 +663,13 @@ QJsonObject CMediaData::toJson( const std::shared_ptr< CSettings > &settings, bo
     retVal[ "premiere_date" ] = fPremiereDate.toString( "MM/dd/yyyy" );
 
     QJsonArray serverInfos;
-    for ( auto &&ii : fInfoForServer )
+    for ( size_t ii = 0; ii < fInfoForServer.size(); ++ii )
     {
-        if ( !ii.second->isValid() )
+        if ( !fInfoForServer[ ii ].has_value() || !fInfoForServer[ ii ]->isValid() )
             continue;
         ;
-        auto serverInfo = ii.second->toJson();
-        serverInfo[ "server_url" ] = ii.first;
+        auto serverInfo = fInfoForServer[ ii ]->toJson();
+        serverInfo[ "server_url" ] = CServerIndex::name( static_cast< int >( ii ) );
         serverInfos.push_back( serverInfo );
     }
     retVal[ "server_infos" ] = serverInfos;
@@ -553,51 +682,53 @@ QJsonObject CMediaData::toJson( const std::shared_ptr< CSettings > &settings, bo
 
 bool CMediaData::onServer() const
 {
-    return !this->fInfoForServer.empty();
+    return std::any_of( fInfoForServer.begin(), fInfoForServer.end(), []( const std::optional< SMediaServerData > &ii ) { return ii.has_value(); } );
 }
 
 void CMediaData::updateFromOther( const QString &otherServerName, std::shared_ptr< CMediaData > other )
 {
-    auto otherMediaData = other->userMediaData( otherServerName );
+    auto otherMediaData = other->serverData( otherServerName );
     if ( !otherMediaData )
         return;
 
-    fInfoForServer[ otherServerName ] = otherMediaData;
-    updateCanBeSynced();
+    auto mediaData = addServerData( CServerIndex::index( otherServerName ) );
+    if ( !mediaData )
+        return;
+
+    *mediaData = *otherMediaData;
+    updateSyncStatus();
+}
+
+void CMediaData::clearServerData( const QString &serverName )
+{
+    auto mediaData = serverData( serverName );
+    if ( !mediaData )
+        return;
+
+    *mediaData = SMediaServerData();
+    updateSyncStatus();
 }
 
 bool CMediaData::needsUpdating( const QString &serverName ) const
 {
     // TODO: When Emby supports last modified use that
 
-    auto mediaData = userMediaData( serverName );
-    if ( !mediaData )
+    auto index = CServerIndex::find( serverName );
+    if ( ( index < 0 ) || ( index >= static_cast< int >( fInfoForServer.size() ) ) || !fInfoForServer[ index ].has_value() )
         return false;
-    return ( mediaData != newestMediaData() );
+    return index != fNewestServer;
 }
 
 std::shared_ptr< SMediaServerData > CMediaData::newestMediaData() const
 {
-    std::shared_ptr< SMediaServerData > retVal;
-    for ( auto &&ii : fInfoForServer )
-    {
-        if ( !ii.second->isValid() )
-            continue;
-
-        if ( !retVal )
-            retVal = ii.second;
-        else
-        {
-            if ( ii.second->fLastPlayedDate > retVal->fLastPlayedDate )
-                retVal = ii.second;
-        }
-    }
-    return retVal;
+    if ( fNewestServer == -1 )
+        return {};
+    return std::shared_ptr< SMediaServerData >( shared_from_this(), &const_cast< CMediaData * >( this )->fInfoForServer[ fNewestServer ].value() );
 }
 
 bool CMediaData::isValidForServer( const QString &serverName ) const
 {
-    auto mediaInfo = userMediaData( serverName );
+    auto mediaInfo = serverData( serverName );
     if ( !mediaInfo )
         return false;
     return mediaInfo->isValid();
@@ -607,15 +738,20 @@ bool CMediaData::isValidForAllServers() const
 {
     for ( auto &&ii : fInfoForServer )
     {
-        if ( !ii.second->isValid() )
+        if ( ii.has_value() && !ii->isValid() )
             return false;
     }
     return true;
 }
 
+bool CMediaData::isValidForAnyServer() const
+{
+    return std::any_of( fInfoForServer.begin(), fInfoForServer.end(), []( const std::optional< SMediaServerData > &ii ) { return ii.has_value() && ii->isValid(); } );
+}
+
 bool CMediaData::canBeSynced() const
 {
-    return fCanBeSynced;
+    return syncStatusSet( eCanBeSynced );
 }
 
 EMediaSyncStatus CMediaData::syncStatus() const
@@ -630,22 +766,7 @@ EMediaSyncStatus CMediaData::syncStatus() const
 
 bool CMediaData::validUserDataEqual() const
 {
-    std::list< std::pair< QString, std::shared_ptr< SMediaServerData > > > validServerData;
-    for ( auto &&ii : fInfoForServer )
-    {
-        if ( ii.second->isValid() )
-            validServerData.push_back( ii );
-    }
-
-    auto pos = validServerData.begin();
-    auto nextPos = validServerData.begin();
-    nextPos++;
-    for ( ; ( pos != validServerData.end() ) && ( nextPos != validServerData.end() ); ++pos, ++nextPos )
-    {
-        if ( !( *pos ).second->userDataEqual( *( ( *nextPos ).second ) ) )
-            return false;
-    }
-    return true;
+    return syncStatusSet( eValidUserDataEqual );
 }
 
 bool CMediaData::isMatch( const QString &name, int year ) const
@@ -655,9 +776,12 @@ bool CMediaData::isMatch( const QString &name, int year ) const
     if ( !isMatch )
         return false;
 
-    if ( SMovieStub::nameKey( name ) == SMovieStub::nameKey( fName ) )
-        return true;
-    if ( SMovieStub::nameKey( name ) == SMovieStub::nameKey( fOriginalTitle ) )
+    return isNameMatch( name, SMovieStub::nameKey( name ) );
+}
+
+bool CMediaData::isNameMatch( const QString &name, const QString &nameKey ) const
+{
+    if ( ( nameKey == fNameKey ) || ( nameKey == fOriginalTitleKey ) )
         return true;
     if ( NSABUtils::NStringUtils::isSimilar( fName, name, true ) )
         return true;
@@ -666,6 +790,39 @@ bool CMediaData::isMatch( const QString &name, int year ) const
     return false;
 }
 
+namespace
+{
+    size_t stringBytes( const QString &str )
+    {
+        if ( str.isNull() )
+            return 0;
+        return sizeof( QArrayData ) + ( str.capacity() + 1 ) * sizeof( QChar );
+    }
+}
+
+size_t CMediaData::memoryUsage() const
+{
+    auto retVal = sizeof( CMediaData );
+    retVal += stringBytes( fName ) + stringBytes( fOriginalTitle );
+    retVal += stringBytes( fNameKey ) + ( fOriginalTitleKey.isSharedWith( fNameKey ) ? 0 : stringBytes( fOriginalTitleKey ) );
+
+    retVal += fProviders.capacity() * sizeof( TProviders::value_type );
+    for ( auto &&ii : fProviders )
+        retVal += stringBytes( ii.second );
+
+    retVal += fExternalUrls.capacity() * sizeof( SExternalUrl );
+    for ( auto &&ii : fExternalUrls )
+        retVal += stringBytes( ii.fPath );
+
+    retVal += fInfoForServer.capacity() * sizeof( std::optional< SMediaServerData > );
+    for ( auto &&ii : fInfoForServer )
+    {
+        if ( ii.has_value() )
+            retVal += stringBytes( ii->fMediaID );
+    }
+    return retVal;
+}
+
 bool CMediaData::isMissingProvider( EMissingProviderIDs missingIdsType ) const
 {
     if ( missingIdsType == EMissingProviderIDs::eNone )
@@ -673,34 +830,34 @@ bool CMediaData::isMissingProvider( EMissingProviderIDs missingIdsType ) const
 
     if ( ( missingIdsType & EMissingProviderIDs::eIMDBid ) != 0 )
     {
-        auto pos = fProviders.find( "Imdb" );
-        if ( pos == fProviders.end() )
+        auto providerID = findProvider( "Imdb" );
+        if ( !providerID )
             return true;
-        return ( *pos ).second.isEmpty();
+        return providerID->isEmpty();
     }
 
     if ( ( missingIdsType & EMissingProviderIDs::eTVRageid ) != 0 )
     {
-        auto pos = fProviders.find( "TvRage" );
-        if ( pos == fProviders.end() )
+        auto providerID = findProvider( "TvRage" );
+        if ( !providerID )
             return true;
-        return ( *pos ).second.isEmpty();
+        return providerID->isEmpty();
     }
 
     if ( ( missingIdsType & EMissingProviderIDs::eTMDBid ) != 0 )
     {
-        auto pos = fProviders.find( "Tmdb" );
-        if ( pos == fProviders.end() )
+        auto providerID = findProvider( "Tmdb" );
+        if ( !providerID )
             return true;
-        return ( *pos ).second.isEmpty();
+        return providerID->isEmpty();
     }
 
     if ( ( missingIdsType & EMissingProviderIDs::eTVDBid ) != 0 )
     {
-        auto pos = fProviders.find( "Tvdb" );
-        if ( pos == fProviders.end() )
+        auto providerID = findProvider( "Tvdb" );
+        if ( !providerID )
             return true;
-        return ( *pos ).second.isEmpty();
+        return providerID->isEmpty();
     }
     return false;
 }
@@ -801,19 +958,6 @@ SCollectionServerInfo::SCollectionServerInfo( const QString &id ) :
 {
 }
 
-bool SCollectionServerInfo::updateMedia( std::shared_ptr< CMediaModel > mediaModel )
-{
-    bool retVal = false;
-    for ( auto &&ii : fItems )
-    {
-        if ( ii->fData && !ii->fData->onServer() )
-        {
-            retVal = ii->updateMedia( mediaModel ) || retVal;
-        }
-    }
-    return retVal;
-}
-
 std::shared_ptr< SMediaCollectionData > SCollectionServerInfo::addMovie( const QString &name, int year, const std::pair< int, int > &resolution, CMediaCollection *parent, int rank )
 {
     auto retVal = std::make_shared< SMediaCollectionData >( std::make_shared< CMediaData >( SMovieStub( name, year, resolution ), "Movie" ), parent );
@@ -857,129 +1001,41 @@ QVariant SMediaCollectionData::data( int column, int role ) const
     return {};
 }
 
-bool SMediaCollectionData::updateMedia( std::shared_ptr< CMediaModel > mediaModel )
-{
-    if ( fData->onServer() )
-        return false;
-
-    auto data = mediaModel->findMedia( fData->name(), fData->premiereDate().year() );
-    if ( data )
-    {
-        fData = data;
-        return true;
-    }
-    return false;
-}
-
 namespace NJSON
 {
     std::optional< std::shared_ptr< CCollections > > CCollections::fromJSON( const QString &fileName, QString *msg /*= nullptr */ )
     {
-        if ( fileName.isEmpty() )
-        {
-            if ( msg )
-                *msg = QString( "Filename is empty" );
-            return {};
-        }
-
-        QFile fi( fileName );
-        if ( !fi.open( QFile::ReadOnly ) )
-        {
-            if ( msg )
-                *msg = QString( "Could not open file '%1', please chek permissions" ).arg( fileName );
-
-            return {};
-        }
-
-        auto data = fi.readAll();
-        QJsonParseError error;
-        auto doc = QJsonDocument::fromJson( data, &error );
-        if ( error.error != QJsonParseError::NoError )
-        {
-            if ( msg )
-                *msg = QString( "Error: %1 @ %2" ).arg( error.errorString() ).arg( error.offset );
-            return {};
-        }
-
-        if ( !doc.isObject() )
-        {
-            if ( msg )
-                *msg = QString( "Error: Top level item should be object" );
-            return {};
-        }
-
-        auto root = doc.object();
-        auto collectionsObj = root[ "collections" ];
-        auto moviesObj = root[ "movies" ];
-        if ( !collectionsObj.isArray() && !moviesObj.isArray() )
-        {
-            if ( msg )
-                *msg = QString( "Error: Top level item should contain an array called movies or collections" );
-            return {};
-        }
-
-        if ( moviesObj.isArray() )
-        {
-            QJsonObject collectionObj;
-            collectionObj[ "collection" ] = "<Unnamed Collection>";
-            collectionObj[ "movies" ] = moviesObj;
-            auto tmp = QJsonArray();
-            tmp.push_back( collectionObj );
-            collectionsObj = tmp;
-        }
-        QJsonArray collections;
-        if ( !collectionsObj.isArray() )
-        {
-            if ( msg )
-                *msg = QString( "Error: Top level item 'collections' should be an array" );
-            return {};
-        }
-
-        collections = collectionsObj.toArray();
+        CMovieListReader reader( fileName );
         auto retVal = std::make_shared< CCollections >();
+        auto ok = reader.read(
+            [ &retVal ]( int collection, const CMovie &movie )
+            {
+                if ( collection >= static_cast< int >( retVal->fCollections.size() ) )
+                    retVal->fCollections.resize( collection + 1 );
+                if ( !retVal->fCollections[ collection ] )
+                    retVal->fCollections[ collection ] = std::make_shared< CCollection >( QString() );
+                retVal->fCollections[ collection ]->fMovies.push_back( movie );
+            },
+            msg );
+        if ( !ok )
+            return {};
 
-        for ( auto &&curr : collections )
+        // a collection without movies is kept, as it was when the whole document was loaded
+        retVal->fCollections.resize( reader.collectionNames().size() );
+        for ( size_t ii = 0; ii < retVal->fCollections.size(); ++ii )
         {
-            auto collection = std::make_shared< CCollection >( curr );
-            retVal->fCollections.push_back( collection );
-            auto movies = collection->movies();
-            retVal->fMovies.insert( retVal->fMovies.end(), movies.begin(), movies.end() );
+            if ( !retVal->fCollections[ ii ] )
+                retVal->fCollections[ ii ] = std::make_shared< CCollection >( QString() );
+            retVal->fCollections[ ii ]->fName = reader.collectionNames()[ ii ];
         }
-
         return retVal;
     }
 
-    CMovie::CMovie( const QJsonValue &curr )
+    CMovie::CMovie( const QString &name, int year, int rank, const std::pair< int, int > &resolution ) :
+        fName( name ),
+        fRank( rank ),
+        fYear( year ),
+        fResolution( resolution )
     {
-        fRank = curr.toObject()[ "rank" ].toInt();
-        if ( !curr.toObject().contains( "rank" ) )
-            fRank = -1;
-        fName = curr.toObject()[ "name" ].toString();
-        fYear = curr.toObject()[ "year" ].toInt();
-        //Q_ASSERT( hasYear() );
-        if ( curr.toObject().contains( "width" ) && curr.toObject().contains( "height" ) )
-            fResolution = { curr.toObject()[ "width" ].toInt(), curr.toObject()[ "width" ].toInt() };
-        else if ( curr.toObject().contains( "type" ) )
-        {
-            auto type = curr.toObject()[ "type" ].toString().toLower();
-            if ( type == "uhd" )
-                fResolution = { 3840, 2160 };
-            else if ( type == "dvd" )
-                fResolution = { 720, 480 };
-            else if ( type.isEmpty() )
-                fResolution = { 1920, 1080 };
-        }
     }
-
-    CCollection::CCollection( const QJsonValue &curr )
-    {
-        fName = curr.toObject()[ "collection" ].toString();
-        auto movies = curr.toObject()[ "movies" ].toArray();
-        for ( auto &&curr : movies )
-        {
-            auto movie = std::make_shared< CMovie >( curr );
-            fMovies.push_back( movie );
-        }
-    }
-
-}
\ No newline at end of file
+}
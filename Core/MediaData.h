@@ -28,10 +28,13 @@
 #include <QDateTime>
 #include <QIcon>
 
+#include "MediaServerData.h"
+
 #include <functional>
 #include <map>
 #include <memory>
 #include <optional>
+#include <vector>
 class CSettings;
 class CServerInfo;
 class CMediaModel;
@@ -41,7 +44,6 @@ class CServerModel;
 class CSyncSystem;
 class QMenu;
 struct SMovieStub;
-struct SMediaServerData;
 
 enum class EMediaSyncStatus
 {
@@ -59,7 +61,22 @@ enum EMissingProviderIDs : uint8_t
     eTVRageid = 0x08
 };
 
-class CMediaData
+// provider name -> provider ID, sorted by provider name, the names are interned
+using TProviders = std::vector< std::pair< QString, QString > >;
+
+struct SExternalUrl
+{
+    QString url() const { return fHost + fPath; }
+
+    QString fName;   // interned
+    QString fHost;   // scheme and host, interned
+    QString fPath;   // remainder of the url
+};
+
+// the per server play state lives in a flat array indexed by CServerIndex
+// userMediaData/newestMediaData hand out pointers into that array which keep the media alive,
+// so media must always be owned by a shared_ptr
+class CMediaData : public std::enable_shared_from_this< CMediaData >
 {
 public:
     static QStringList getHeaderLabels();
@@ -67,7 +84,9 @@ public:
     static std::function< QString( uint64_t ) > mecsToStringFunc();
 
     CMediaData( const QJsonObject &mediaObj, std::shared_ptr< CServerModel > serverModel );
+    CMediaData( const QJsonObject &mediaObj, const QStringList &serverNames );   // does not touch the server model, safe to use from worker threads
     CMediaData( const SMovieStub& movieStub, const QString &type );   // stub for dummy media
+    bool isMovieStub() const { return fIsMovieStub; }
 
     static bool isExtra( const QJsonObject &obj );
     bool hasProviderIDs() const;
@@ -75,28 +94,34 @@ public:
 
     QString name() const;
     QString originalTitle() const { return fOriginalTitle; }
+    QString nameKey() const { return fNameKey; }   // the SMovieStub::nameKey of the name, computed when the media is created
+    QString originalTitleKey() const { return fOriginalTitleKey; }
     QString seriesName() const;
     QString mediaType() const;
     bool beenLoaded( const QString &serverName ) const;
 
     void loadData( const QString &serverName, const QJsonObject &object );
     void updateFromOther( const QString &otherServerName, std::shared_ptr< CMediaData > other );
+    void clearServerData( const QString &serverName );   // the media was removed from the server, the slot is kept so handed out pointers stay valid
 
     QUrlQuery getSearchForMediaQuery() const;
 
     QString getProviderID( const QString &provider );
     std::map< QString, QString > getProviders( bool addKeyIfEmpty = false ) const;
-    std::map< QString, QString > getExternalUrls() const { return fExternalUrls; }
+    const TProviders &providers() const { return fProviders; }
+    std::map< QString, QString > getExternalUrls() const;
 
     QString externalUrlsText() const;
 
     QString getMediaID( const QString &serverName ) const;
     void setMediaID( const QString &serverName, const QString &id );
 
-    void updateCanBeSynced();
+    // recomputes the cached sync status, call after changing the play state returned by userMediaData
+    void updateSyncStatus();
 
     bool isValidForServer( const QString &serverName ) const;
     bool isValidForAllServers() const;
+    bool isValidForAnyServer() const;
     bool canBeSynced() const;
     bool validUserDataEqual() const;
     EMediaSyncStatus syncStatus() const;
@@ -141,6 +166,7 @@ public:
 
     bool onServer() const;
     bool isMatch( const QString &name, int year ) const;
+    bool isNameMatch( const QString &name, const QString &nameKey ) const;   // isMatch without the year check, thread safe
 
     bool isMissingProvider( EMissingProviderIDs missingIdsType ) const;
 
@@ -149,43 +175,51 @@ public:
     std::optional< int > season() const { return fSeason; }
     std::optional< int > episode() const { return fEpisode; }
 
+    size_t memoryUsage() const;   // estimated bytes owned by this item, interned strings are not counted
+
 private:
+    SMediaServerData *serverData( const QString &serverName );
+    const SMediaServerData *serverData( const QString &serverName ) const;
+    SMediaServerData *addServerData( int serverIndex );   // nullptr for a server registered after this media was created
+    const QString *findProvider( const QString &providerName ) const;
+
     QString searchKey() const;
     void computeName( const QJsonObject &media );
+    void computeNameKeys();
     void loadResolution( const QJsonArray &mediaSources );
 
-    template< typename T >
-    bool allEqual( std::function< T( std::shared_ptr< SMediaServerData > ) > func ) const
-    {
-        std::optional< T > prevValue;
-        for ( auto &&ii : fInfoForServer )
-        {
-            if ( !ii.second->isValid() )
-                continue;
-
-            if ( !prevValue.has_value() )
-                prevValue = func( ii.second );
-            else if ( prevValue.value() != func( ii.second ) )
-                return false;
-        }
-        return true;
-    }
     QString getProviderList() const;
 
-    QString fType;
+    QString fType;   // interned
     QString fName;
     QString fOriginalTitle;
-    QString fSeriesName;   // only valid for EpisodeTypes
+    QString fNameKey;
+    QString fOriginalTitleKey;
+    QString fSeriesName;   // only valid for EpisodeTypes, interned
     std::optional< int > fSeason;   // only valid for EpisodeTypes
     std::optional< int > fEpisode;   // only valid for EpisodeTypes
-    std::map< QString, QString > fProviders;
-    std::map< QString, QString > fExternalUrls;
+    TProviders fProviders;
+    std::vector< SExternalUrl > fExternalUrls;   // sorted by name
     std::pair< int, int > fResolution{ 0, 0 };
     QDate fPremiereDate;
     bool fIsMissing{ false };
+    bool fIsMovieStub{ false };
 
-    bool fCanBeSynced{ false };
-    std::map< QString, std::shared_ptr< SMediaServerData > > fInfoForServer;
+    enum ESyncStatusFlags : uint8_t
+    {
+        eCanBeSynced = 0x01,
+        eValidUserDataEqual = 0x02,
+        eAllPlayedEqual = 0x04,
+        eAllFavoriteEqual = 0x08,
+        eAllLastPlayedEqual = 0x10,
+        eAllPlayCountEqual = 0x20,
+        eAllPlaybackPositionTicksEqual = 0x40
+    };
+    bool syncStatusSet( ESyncStatusFlags flag ) const { return ( fSyncStatus & flag ) != 0; }
+
+    uint8_t fSyncStatus{ 0 };   // ESyncStatusFlags, computed by updateSyncStatus
+    int fNewestServer{ -1 };   // CServerIndex of the valid server with the newest play state
+    std::vector< std::optional< SMediaServerData > > fInfoForServer;   // CServerIndex -> data, empty slot when the server is not enabled
 
     static std::function< QString( uint64_t ) > sMSecsToStringFunc;
 };
@@ -200,7 +234,6 @@ struct SMediaCollectionData
     }
     QVariant data( int column, int role ) const;
     ;
-    bool updateMedia( std::shared_ptr< CMediaModel > mediaModel );
     std::shared_ptr< CMediaData > fData;
     CMediaCollection *fCollection{ nullptr };
 };
@@ -209,8 +242,6 @@ struct SCollectionServerInfo
 {
     SCollectionServerInfo( const QString &id );
 
-    bool updateMedia( std::shared_ptr< CMediaModel > mediaModel );
-
     int childCount() const { return static_cast< int >( fItems.size() ); }
     int numMissing() const;
 
@@ -243,7 +274,6 @@ public:
 
     std::shared_ptr< SMediaCollectionData > addMovie( const QString &name, int year, const std::pair< int, int > &resolution, int rank );
     void setItems( const std::list< std::shared_ptr< CMediaData > > &items );
-    bool updateMedia( std::shared_ptr< CMediaModel > mediaModel ) { return fCollectionInfo->updateMedia( mediaModel ); }
     bool missingMedia() const { return fCollectionInfo->missingMedia(); }
 
     int numMovies() const { return childCount(); }
@@ -273,7 +303,7 @@ namespace NJSON
     class CMovie
     {
     public:
-        CMovie( const QJsonValue &curr );
+        CMovie( const QString &name, int year, int rank, const std::pair< int, int > &resolution );
 
         QString name() const { return fName; }
         int rank() const { return fRank; }
@@ -292,28 +322,30 @@ namespace NJSON
     class CCollection
     {
     public:
-        CCollection( const QJsonValue &curr );
+        CCollection( const QString &name ) :
+            fName( name )
+        {
+        }
 
         QString name() const { return fName; }
-        const std::list< std::shared_ptr< CMovie > > &movies() const { return fMovies; }
+        const std::vector< CMovie > &movies() const { return fMovies; }
 
     private:
+        friend class CCollections;
         QString fName;
-        std::list< std::shared_ptr< CMovie > > fMovies;
+        std::vector< CMovie > fMovies;
     };
 
     class CCollections
     {
     public:
         CCollections() {}
-        static std::optional< std::shared_ptr< CCollections > > fromJSON( const QString &fileName, QString *msg = nullptr );
+        static std::optional< std::shared_ptr< CCollections > > fromJSON( const QString &fileName, QString *msg = nullptr );   // any format CMovieListReader reads
 
-        const std::list< std::shared_ptr< CCollection > > &collections() const { return fCollections; }
-        const std::list< std::shared_ptr< CMovie > > &movies() const { return fMovies; }
+        const std::vector< std::shared_ptr< CCollection > > &collections() const { return fCollections; }
 
     private:
-        std::list< std::shared_ptr< CCollection > > fCollections;
-        std::list< std::shared_ptr< CMovie > > fMovies;
+        std::vector< std::shared_ptr< CCollection > > fCollections;
     };
 }
 #endif
@@ -1,4 +1,5 @@
 #include "MediaModel.h"
+#include "FunctionRunnable.h"
 #include "MediaData.h"
 #include "MergeMedia.h"
 #include "MovieStub.h"
@@ -8,6 +9,7 @@
 #include "ServerModel.h"
 #include "SABUtils/StringUtils.h"
 #include "ProgressSystem.h"
+#include "Logging.h"
 
 #include <QJsonObject>
 #include <QJsonArray>
@@ -16,7 +18,11 @@
 #include <QColor>
 #include <QInputDialog>
 #include <QTimer>
+#include <QThreadPool>
+#include <QSemaphore>
 
+#include <algorithm>
+#include <atomic>
 #include <optional>
 #include <vector>
 #include <unordered_map>
@@ -25,9 +31,14 @@ CMediaModel::CMediaModel( std::shared_ptr< CSettings > settings, std::shared_ptr
     QAbstractTableModel( parent ),
     fSettings( settings ),
     fServerModel( serverModel ),
-    fMergeSystem( new CMergeMedia )
+    fMergeSystem( new CMergeMedia ),
+    fNameIndex( std::make_unique< CMediaNameIndex >() )
 {
-    connect( this, &CMediaModel::dataChanged, this, &CMediaModel::sigMediaChanged );
+    fFlushChangesTimer = new QTimer( this );
+    fFlushChangesTimer->setSingleShot( true );
+    fFlushChangesTimer->setInterval( 50 );
+    connect( fFlushChangesTimer, &QTimer::timeout, this, &CMediaModel::slotFlushChanges );
+
     connect( this, &CMediaModel::modelReset, this, &CMediaModel::sigMediaChanged );
 }
 
@@ -272,12 +283,54 @@ void CMediaModel::addMediaInfo( const QString &serverName, std::shared_ptr< CMed
 
 void CMediaModel::updateMediaData( std::shared_ptr< CMediaData > mediaData )
 {
+    mediaData->updateSyncStatus();   // the play state may have been changed in place
+
     auto pos = fMediaToPos.find( mediaData );
     if ( pos == fMediaToPos.end() )
         return;
 
-    int row = static_cast< int >( ( *pos ).second );
-    emit dataChanged( index( row, 0 ), index( row, columnCount() - 1 ) );
+    fNameIndex->update( mediaData );   // a reload can change the titles or premiere date
+    fSeriesIndex.update( mediaData );
+
+    fChangedMedia.insert( mediaData );
+    queueMediaChanged();
+}
+
+// the timer is only started when idle, so a steady stream of updates is still flushed every interval
+void CMediaModel::queueMediaChanged()
+{
+    fMediaChangedPending = true;
+    if ( !fFlushChangesTimer->isActive() )
+        fFlushChangesTimer->start();
+}
+
+// one dataChanged per run of contiguous rows and a single sigMediaChanged for the whole burst
+void CMediaModel::slotFlushChanges()
+{
+    std::vector< size_t > rows;
+    rows.reserve( fChangedMedia.size() );
+    for ( auto &&ii : fChangedMedia )
+    {
+        auto pos = fMediaToPos.find( ii );
+        if ( pos != fMediaToPos.end() )   // the row may have been removed since it was queued
+            rows.push_back( ( *pos ).second );
+    }
+    fChangedMedia.clear();
+    std::sort( rows.begin(), rows.end() );
+
+    for ( size_t ii = 0; ii < rows.size(); )
+    {
+        auto jj = ii + 1;
+        while ( ( jj < rows.size() ) && ( rows[ jj ] == rows[ jj - 1 ] + 1 ) )
+            ++jj;
+        emit dataChanged( index( static_cast< int >( rows[ ii ] ), 0 ), index( static_cast< int >( rows[ jj - 1 ] ), columnCount() - 1 ) );
+        ii = jj;
+    }
+
+    if ( !fMediaChangedPending )
+        return;
+    fMediaChangedPending = false;
+    emit sigMediaChanged();
 }
 
 void CMediaModel::beginBatchLoad()
@@ -359,11 +412,15 @@ void CMediaModel::clear()
     fMediaMap.clear();
     // fCollections.clear();
     fData.clear();
-    fDataMap.clear();
+    fNameIndex->clear();
+    fSeriesIndex.clear();
     fMediaToPos.clear();
     fProviderNames.clear();
     fProviderColumnsByColumn.clear();
     fDirSort = eNoSort;
+    fChangedMedia.clear();
+    fMediaChangedPending = false;
+    fFlushChangesTimer->stop();
 
     endResetModel();
 }
@@ -388,10 +445,13 @@ void CMediaModel::updateProviderColumns( std::shared_ptr< CMediaData > mediaData
     }
 }
 
+// the settings only change which rows are shown and how they look, the rows themselves stay
 void CMediaModel::settingsChanged()
 {
-    beginResetModel();
-    endResetModel();
+    if ( !fData.empty() )
+        emit dataChanged( index( 0, 0 ), index( rowCount() - 1, columnCount() - 1 ) );
+    fChangedMedia.clear();   // already covered by the full range
+    queueMediaChanged();
     emit sigSettingsChanged();
 }
 
@@ -417,9 +477,110 @@ std::shared_ptr< CMediaData > CMediaModel::getMediaDataForID( const QString &ser
     return {};
 }
 
+namespace
+{
+    struct SDecodeMediaJob
+    {
+        static constexpr int kChunkSize = 256;
+
+        SDecodeMediaJob( const QString &serverName, const QJsonArray &mediaArray, const QStringList &serverNames ) :
+            fServerName( serverName ),
+            fMediaArray( mediaArray ),
+            fServerNames( serverNames ),
+            fResults( mediaArray.count() )
+        {
+        }
+
+        static int numChunks( int count ) { return ( count + kChunkSize - 1 ) / kChunkSize; }
+
+        void decodeChunks()
+        {
+            auto count = fMediaArray.count();
+            for ( auto begin = fNextChunk.fetch_add( kChunkSize ); begin < count; begin = fNextChunk.fetch_add( kChunkSize ) )
+            {
+                auto end = std::min( begin + kChunkSize, count );
+                for ( auto ii = begin; ii < end; ++ii )
+                    fResults[ ii ] = CMediaModel::decodeMedia( fServerName, fMediaArray.at( ii ).toObject(), fServerNames );
+            }
+        }
+
+        QString fServerName;
+        QJsonArray fMediaArray;
+        QStringList fServerNames;
+        std::vector< SDecodedMedia > fResults;
+        std::atomic< int > fNextChunk{ 0 };
+        std::atomic< int > fRunning{ 0 };
+    };
+}
+
+SDecodedMedia CMediaModel::decodeMedia( const QString &serverName, const QJsonObject &media, const QStringList &serverNames )
+{
+    SDecodedMedia retVal;
+    if ( CMediaData::isExtra( media ) )
+        return retVal;
+
+    retVal.fMedia = media;
+    if ( media.contains( "ParentIndexNumber" ) && media.contains( "IndexNumber" ) )
+        retVal.fEpisodeID = QString( "S%1E%2" ).arg( media[ "ParentIndexNumber" ].toInt(), 2, 10, QChar( '0' ) ).arg( media[ "IndexNumber" ].toInt(), 2, 10, QChar( '0' ) );
+
+    retVal.fMediaData = std::make_shared< CMediaData >( media, serverNames );
+    retVal.fMediaData->loadData( serverName, media );
+    return retVal;
+}
+
+// for callers that need the items right away, the calling thread works through the chunks along with the pool, so a busy pool can never stall the load
+std::vector< SDecodedMedia > CMediaModel::decodeMedia( const QString &serverName, const QJsonArray &mediaArray, const QStringList &serverNames )
+{
+    SDecodeMediaJob job( serverName, mediaArray, serverNames );
+
+    auto numHelpers = std::min( QThreadPool::globalInstance()->maxThreadCount(), SDecodeMediaJob::numChunks( mediaArray.count() ) - 1 );
+    QSemaphore helpersDone;
+    for ( int ii = 0; ii < numHelpers; ++ii )
+    {
+        QThreadPool::globalInstance()->start( new CFunctionRunnable(
+            [ &job, &helpersDone ]()
+            {
+                job.decodeChunks();
+                helpersDone.release();
+            } ) );
+    }
+    job.decodeChunks();
+    if ( numHelpers > 0 )
+        helpersDone.acquire( numHelpers );
+    return std::move( job.fResults );
+}
+
+void CMediaModel::decodeMedia( QThreadPool *pool, const QString &serverName, const QJsonArray &mediaArray, const QStringList &serverNames, std::function< void( std::vector< SDecodedMedia > &decoded ) > onDecoded )
+{
+    auto job = std::make_shared< SDecodeMediaJob >( serverName, mediaArray, serverNames );
+
+    auto numWorkers = std::max( 1, std::min( pool->maxThreadCount(), SDecodeMediaJob::numChunks( mediaArray.count() ) ) );
+    job->fRunning = numWorkers;
+    for ( int ii = 0; ii < numWorkers; ++ii )
+    {
+        pool->start( new CFunctionRunnable(
+            [ job, onDecoded ]()
+            {
+                job->decodeChunks();
+                if ( --job->fRunning == 0 )
+                    onDecoded( job->fResults );
+            } ) );
+    }
+}
+
 std::shared_ptr< CMediaData > CMediaModel::loadMedia( const QString &serverName, const QJsonObject &media )
 {
-    qDebug().nospace().noquote() << QJsonDocument( media ).toJson();
+    auto decoded = decodeMedia( serverName, media, fServerModel->enabledServerNames() );
+    return loadMedia( serverName, decoded );
+}
+
+// cheap main thread half of the load, the parsing was done by decodeMedia
+std::shared_ptr< CMediaData > CMediaModel::loadMedia( const QString &serverName, SDecodedMedia &decoded )
+{
+    if ( !decoded.isValid() )
+        return {};
+
+    qCDebug( lcMediaModel ).nospace().noquote() << QJsonDocument( decoded.fMedia ).toJson();
 
     std::shared_ptr< CMediaData > mediaData;
 
@@ -427,16 +588,12 @@ std::shared_ptr< CMediaData > CMediaModel::loadMedia( const QString &serverName,
     if ( pos == fMediaMap.end() )
         pos = fMediaMap.insert( std::make_pair( serverName, TMediaIDToMediaData() ) ).first;
 
-    auto seasonID = media[ "ParentIndexNumber" ].toInt();
-    auto episodeID = media[ "IndexNumber" ].toInt();
-    auto id = QString( "S%1E%2" ).arg( seasonID, 2, 10, QChar( '0' ) ).arg( episodeID, 2, 10, QChar( '0' ) );
-
-    if ( !media.contains( "ParentIndexNumber" ) || !media.contains( "IndexNumber" ) )
-        id = QString::number( ( *pos ).second.size() );
+    auto id = decoded.fEpisodeID.has_value() ? decoded.fEpisodeID.value() : QString::number( ( *pos ).second.size() );
 
     auto pos2 = ( *pos ).second.find( id );
-    if ( pos2 == ( *pos ).second.end() )
-        mediaData = std::make_shared< CMediaData >( media, fServerModel );
+    bool isNew = ( pos2 == ( *pos ).second.end() );
+    if ( isNew )
+        mediaData = decoded.fMediaData;
     else
         mediaData = ( *pos2 ).second;
     // qDebug() << isLHSServer << mediaData->name();
@@ -453,10 +610,36 @@ std::shared_ptr< CMediaData > CMediaModel::loadMedia( const QString &serverName,
     }
     */
 
-    addMediaInfo( serverName, mediaData, media );
+    if ( isNew && fMergeSystem->isMerged() )
+        return mergeNewMedia( serverName, id, mediaData );
+
+    if ( isNew )
+    {
+        ( *pos ).second[ id ] = mediaData;
+        fMergeSystem->addMediaInfo( serverName, mediaData );
+        updateMediaData( mediaData );
+    }
+    else
+        addMediaInfo( serverName, mediaData, decoded.fMedia );
     return mediaData;
 }
 
+// media loaded after the full merge, eg a collection reload, is joined on its own and only its row is inserted or changed
+std::shared_ptr< CMediaData > CMediaModel::mergeNewMedia( const QString &serverName, const QString &mediaID, const std::shared_ptr< CMediaData > &mediaData )
+{
+    bool isNewMedia = false;
+    auto merged = fMergeSystem->mergeItem( serverName, mediaData, isNewMedia );
+    fMediaMap[ serverName ][ mediaID ] = merged;
+    if ( isNewMedia )
+    {
+        fAllMedia.insert( merged );
+        addMedia( merged, true );
+    }
+    else
+        updateMediaData( merged );
+    return merged;
+}
+
 void CMediaModel::removeMedia( const QString &serverName, const std::shared_ptr< CMediaData > &mediaData )
 {
     auto pos = fMediaMap.find( serverName );
@@ -466,12 +649,25 @@ void CMediaModel::removeMedia( const QString &serverName, const std::shared_ptr<
         auto pos2 = ( *pos ).second.find( mediaID );
         if ( pos2 != ( *pos ).second.end() )
             ( *pos ).second.erase( pos2 );
+    }
 
-        auto pos3 = fMediaToPos.find( mediaData );
-        if ( pos3 != fMediaToPos.end() )
-            fMediaToPos.erase( pos3 );
+    if ( !fMergeSystem->isMerged() )
+    {
+        fMergeSystem->removeMedia( serverName, mediaData );
+        return;
     }
-    fMergeSystem->removeMedia( serverName, mediaData );
+
+    // still on another server, only its row changes
+    if ( !fMergeSystem->removeItem( serverName, mediaData ) )
+    {
+        updateMediaData( mediaData );
+        return;
+    }
+
+    fAllMedia.erase( mediaData );
+    auto pos3 = fMediaToPos.find( mediaData );
+    if ( pos3 != fMediaToPos.end() )
+        removeMediaRow( ( *pos3 ).second );
 }
 
 std::shared_ptr< CMediaData > CMediaModel::reloadMedia( const QString &serverName, const QJsonObject &media, const QString &mediaID )
@@ -503,134 +699,176 @@ bool CMediaModel::mergeMedia( std::shared_ptr< CProgressSystem > progressSystem
     return !progressSystem->wasCanceled();
 }
 
+// diffs the merged media against the current rows, the proxies see row removals, one row insert and a data change instead of a reset
 void CMediaModel::loadMergedMedia( std::shared_ptr< CProgressSystem > progressSystem )
 {
     progressSystem->pushState();
     progressSystem->setTitle( tr( "Loading merged media data" ) );
     progressSystem->setMaximum( static_cast< int >( fAllMedia.size() ) );
     progressSystem->setValue( 0 );
-    beginResetModel();
-    fData.reserve( fAllMedia.size() );
+
+    // movie stubs are not part of the merge and keep their rows
+    removeMediaRows( [ this ]( const std::shared_ptr< CMediaData > &media ) { return media->onServer() && ( fAllMedia.find( media ) == fAllMedia.end() ); } );
+    if ( !fData.empty() )
+        emit dataChanged( index( 0, 0 ), index( rowCount() - 1, columnCount() - 1 ) );
+    fChangedMedia.clear();
+    queueMediaChanged();
+
+    std::vector< std::shared_ptr< CMediaData > > newMedia;
     for ( auto &&ii : fAllMedia )
     {
-        addMedia( ii, false );
+        if ( fMediaToPos.find( ii ) == fMediaToPos.end() )
+            newMedia.push_back( ii );
+    }
+
+    if ( !newMedia.empty() )
+    {
+        for ( auto &&ii : newMedia )
+            updateProviderColumns( ii );
+
+        beginInsertRows( QModelIndex(), static_cast< int >( fData.size() ), static_cast< int >( fData.size() + newMedia.size() - 1 ) );
+        fData.reserve( fData.size() + newMedia.size() );
+        for ( auto &&ii : newMedia )
+            appendMedia( ii );
+        endInsertRows();
     }
-    endResetModel();
     progressSystem->popState();
 }
 
 void CMediaModel::addMedia( const std::shared_ptr< CMediaData > &media, bool emitUpdate )
 {
+    updateProviderColumns( media );
     if ( emitUpdate )
         beginInsertRows( QModelIndex(), static_cast< int >( fData.size() ), static_cast< int >( fData.size() ) );
-    fMediaToPos[ media ] = fData.size();
-    fData.push_back( media );
-    fDataMap[ SMovieStub::nameKey( media->name() ) ] = media;
-    fDataMap[ SMovieStub::nameKey( media->originalTitle() ) ] = media;
-    updateProviderColumns( media );
+    appendMedia( media );
     if ( emitUpdate )
+    {
         endInsertRows();
+        queueMediaChanged();
+    }
 }
 
-void CMediaModel::removeMovieStub( const SMovieStub &movieStub )
+void CMediaModel::appendMedia( const std::shared_ptr< CMediaData > &media )
 {
-    auto pos = fDataMap.find( movieStub.nameKey() );
-    if ( pos == fDataMap.end() )
-        return;
-
-    removeMovieStub( ( *pos ).second );
+    fMediaToPos[ media ] = fData.size();
+    fData.push_back( media );
+    fNameIndex->add( media );
+    fSeriesIndex.add( media );
 }
 
-void CMediaModel::removeMovieStub( const std::shared_ptr< CMediaData > &media )
+void CMediaModel::removeMediaRow( size_t row )
 {
-    beginResetModel();
-    if ( media->onServer() )
-        return;
-
-    auto it = std::remove_if( fData.begin(), fData.end(), [ media ]( std::shared_ptr< CMediaData > data ) { return data == media; } );
-    fData.erase( it, fData.end() );
-
-    auto pos = fDataMap.find( SMovieStub::nameKey( media->name() ) );
-    if ( pos != fDataMap.end() )
-        fDataMap.erase( pos );
-
-    auto pos2 = fMediaToPos.find( media );
-    if ( pos2 != fMediaToPos.end() )
-        fMediaToPos.erase( pos2 );
-    endResetModel();
+    auto media = fData[ row ];
+    beginRemoveRows( QModelIndex(), static_cast< int >( row ), static_cast< int >( row ) );
+    fMediaToPos.erase( media );
+    fNameIndex->remove( media );
+    fSeriesIndex.remove( media );
+    fData.erase( fData.begin() + row );
+    reindexRows( row );
+    endRemoveRows();
+    queueMediaChanged();
 }
 
-void CMediaModel::clearAllMovieStubs()
+// contiguous rows are removed together, walking from the back keeps the earlier row numbers valid
+void CMediaModel::removeMediaRows( const std::function< bool( const std::shared_ptr< CMediaData > &media ) > &shouldRemove )
 {
-    beginResetModel();
-    auto it = std::remove_if( fData.begin(), fData.end(), []( std::shared_ptr< CMediaData > data ) { return !data->onServer(); } );
-    fData.erase( it, fData.end() );
-
-    for ( auto ii = fDataMap.begin(); ii != fDataMap.end(); )
+    std::optional< size_t > firstRemoved;
+    for ( auto end = fData.size(); end > 0; )
     {
-        if ( !( *ii ).second->onServer() )
+        if ( !shouldRemove( fData[ end - 1 ] ) )
         {
-            ii = fDataMap.erase( ii );
+            --end;
             continue;
         }
-        ++ii;
-    }
 
-    for ( auto ii = fMediaToPos.begin(); ii != fMediaToPos.end(); )
-    {
-        if ( !( *ii ).first->onServer() )
+        auto begin = end - 1;
+        while ( ( begin > 0 ) && shouldRemove( fData[ begin - 1 ] ) )
+            --begin;
+
+        beginRemoveRows( QModelIndex(), static_cast< int >( begin ), static_cast< int >( end - 1 ) );
+        for ( auto ii = begin; ii < end; ++ii )
         {
-            ii = fMediaToPos.erase( ii );
-            continue;
+            fMediaToPos.erase( fData[ ii ] );
+            fNameIndex->remove( fData[ ii ] );
+            fSeriesIndex.remove( fData[ ii ] );
         }
-        ++ii;
-    }
-    endResetModel();
-}
+        fData.erase( fData.begin() + begin, fData.begin() + end );
+        endRemoveRows();
 
-void CMediaModel::addMovieStub( const SMovieStub &movieStub, std::function< bool( std::shared_ptr< CMediaData > mediaData ) > equal )
-{
-    auto pos = fDataMap.find( movieStub.nameKey() );
-    if ( pos != fDataMap.end() )
-    {
-        if ( equal( ( *pos ).second ) )
-            return;
+        firstRemoved = begin;
+        end = begin;
     }
 
-    for ( auto &&ii : fData )
+    if ( firstRemoved.has_value() )
     {
-        if ( equal( ii ) )
-            return;
+        reindexRows( firstRemoved.value() );
+        queueMediaChanged();
     }
+}
 
-    auto mediaData = std::make_shared< CMediaData >( movieStub, "Movie" );
-    addMedia( mediaData, true );
+void CMediaModel::reindexRows( size_t firstRow )
+{
+    for ( auto ii = firstRow; ii < fData.size(); ++ii )
+        fMediaToPos[ fData[ ii ] ] = ii;
 }
 
-std::set< QString > CMediaModel::getKnownShows() const
+void CMediaModel::removeMovieStub( const SMovieStub &movieStub )
 {
-    std::set< QString > knownShows;
-    for ( auto &&ii : fAllMedia )
-    {
-        if ( ii->mediaType() != "Episode" )
-            continue;
-        auto name = ii->seriesName();
-        if ( name.isEmpty() )
-            continue;
+    auto media = fNameIndex->find( movieStub.nameKey(), {}, 0, []( const std::shared_ptr< CMediaData > &media ) { return !media->onServer(); } );
+    if ( !media )
+        return;
 
-        knownShows.insert( ii->seriesName() );
-    }
-    return knownShows;
+    removeMovieStub( media );
+}
+
+void CMediaModel::removeMovieStub( const std::shared_ptr< CMediaData > &media )
+{
+    if ( media->onServer() )
+        return;
+
+    auto pos = fMediaToPos.find( media );
+    if ( pos != fMediaToPos.end() )
+        removeMediaRow( ( *pos ).second );
+}
+
+void CMediaModel::clearAllMovieStubs()
+{
+    removeMediaRows( []( const std::shared_ptr< CMediaData > &media ) { return !media->onServer(); } );
 }
 
+void CMediaModel::addMovieStub( const SMovieStub &movieStub, int yearTolerance )
+{
+    if ( fNameIndex->find( movieStub.nameKey(), movieStub.fYear, yearTolerance ) )
+        return;
+
+    auto mediaData = std::make_shared< CMediaData >( movieStub, "Movie" );
+    addMedia( mediaData, true );
+}
+
+// the year window is the one CMediaData::isMatch uses
 std::shared_ptr< CMediaData > CMediaModel::findMedia( const QString &name, int year ) const
 {
-    for ( auto &&ii : fAllMedia )
+    return fNameIndex->findMatch( name, year, 3 );
+}
+
+// the copy is only made here for the first snapshot, or when the last one is still read or the changes outgrew it
+// otherwise the changes since the last snapshot are handed over and replayed by the thread asking for the copy
+std::function< std::shared_ptr< const CMediaNameIndex >() > CMediaModel::nameIndexSnapshot()
+{
+    auto changes = fNameIndex->takeChanges();
+    if ( !changes.has_value() || !fNameIndexSnapshot || ( fNameIndexSnapshot.use_count() > 1 ) )
     {
-        if ( ii->isMatch( name, year ) )
-            return ii;
+        fNameIndexSnapshot = std::make_shared< CMediaNameIndex >( *fNameIndex );
+        fNameIndexSnapshot->recordChanges( false );
+        fNameIndex->recordChanges( true );
+        return [ snapshot = fNameIndexSnapshot ]() -> std::shared_ptr< const CMediaNameIndex > { return snapshot; };
     }
-    return {};
+
+    return [ snapshot = fNameIndexSnapshot, changes = std::move( changes.value() ) ]() -> std::shared_ptr< const CMediaNameIndex >
+    {
+        snapshot->apply( changes );
+        return snapshot;
+    };
 }
 
 QVariant CMediaModel::getColor( const QModelIndex &index, const QString &serverName, bool background ) const
@@ -764,6 +1002,7 @@ CMediaFilterModel::CMediaFilterModel( QObject *parent ) :
     QSortFilterProxyModel( parent )
 {
     setDynamicSortFilter( false );
+    connect( this, &QSortFilterProxyModel::sourceModelChanged, [ this ]() { connect( dynamic_cast< CMediaModel * >( sourceModel() ), &CMediaModel::sigSettingsChanged, [ this ]() { invalidateFilter(); } ); } );
 }
 
 bool CMediaFilterModel::filterAcceptsRow( int source_row, const QModelIndex &source_parent ) const
@@ -2,6 +2,8 @@
 #define __MEDIAMODEL_H
 
 #include "IServerForColumn.h"
+#include "MediaNameIndex.h"
+#include "SeriesIndex.h"
 
 #include <QAbstractTableModel>
 #include <QSortFilterProxyModel>
@@ -10,9 +12,11 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <memory>
+#include <functional>
 #include <optional>
 #include <set>
 #include <QDate>
+#include <QJsonObject>
 
 class CSettings;
 class CMediaData;
@@ -24,10 +28,23 @@ class CServerModel;
 class CSyncSystem;
 class CServerInfo;
 class QJsonObject;
+class QTimer;
+class QJsonArray;
+class QThreadPool;
 struct SMovieStub;
 
 using TMediaIDToMediaData = std::map< QString, std::shared_ptr< CMediaData > >;
 
+// a media item parsed off the GUI thread, it is not part of any model until passed to CMediaModel::loadMedia
+struct SDecodedMedia
+{
+    bool isValid() const { return fMediaData.get() != nullptr; }
+
+    QJsonObject fMedia;
+    std::shared_ptr< CMediaData > fMediaData;   // already loaded for the server
+    std::optional< QString > fEpisodeID;
+};
+
 class CMediaModel : public QAbstractTableModel, public IServerForColumn
 {
     friend struct SMediaSummary;
@@ -95,6 +112,13 @@ public:
     std::shared_ptr< CMediaData > getMediaData( const QModelIndex &idx ) const;
     std::shared_ptr< CMediaData > getMediaDataForID( const QString &serverName, const QString &mediaID ) const;
     std::shared_ptr< CMediaData > loadMedia( const QString &serverName, const QJsonObject &media );
+    std::shared_ptr< CMediaData > loadMedia( const QString &serverName, SDecodedMedia &decoded );
+
+    // parses the items on the thread pool, extras are left invalid, the order of the array is kept
+    static std::vector< SDecodedMedia > decodeMedia( const QString &serverName, const QJsonArray &mediaArray, const QStringList &serverNames );
+    // returns at once, onDecoded is called on the pool thread that finished last, the caller posts the items to its own thread for loadMedia
+    static void decodeMedia( QThreadPool *pool, const QString &serverName, const QJsonArray &mediaArray, const QStringList &serverNames, std::function< void( std::vector< SDecodedMedia > &decoded ) > onDecoded );
+    static SDecodedMedia decodeMedia( const QString &serverName, const QJsonObject &media, const QStringList &serverNames );
     std::shared_ptr< CMediaData > reloadMedia( const QString &serverName, const QJsonObject &media, const QString &mediaID );
 
     void removeMedia( const QString &serverName, const std::shared_ptr< CMediaData > &media );
@@ -111,10 +135,13 @@ public:
     using TMediaSet = std::unordered_set< std::shared_ptr< CMediaData > >;
 
     TMediaSet getAllMedia() const { return fAllMedia; }
-    std::set< QString > getKnownShows() const;
+    std::set< QString > getKnownShows() const { return fSeriesIndex.names(); }
+    const CSeriesIndex &seriesIndex() const { return fSeriesIndex; }
     bool hasMedia() const { return !fAllMedia.empty(); }
 
     std::shared_ptr< CMediaData > findMedia( const QString &name, int year ) const;
+    // call the returned function once, off the UI thread, for a read only copy of the index, later changes to the model are not seen, findMatch on it is thread safe
+    std::function< std::shared_ptr< const CMediaNameIndex >() > nameIndexSnapshot();
 
     using iterator = typename TMediaSet::iterator;
     using const_iterator = typename TMediaSet::const_iterator;
@@ -124,7 +151,7 @@ public:
     const_iterator begin() const { return fAllMedia.cbegin(); }
     const_iterator end() const { return fAllMedia.cend(); }
 
-    void addMovieStub( const SMovieStub &movieStub, std::function< bool( std::shared_ptr< CMediaData > mediaData ) > equal );
+    void addMovieStub( const SMovieStub &movieStub, int yearTolerance = 0 );   // no stub is added when a row matches the name key within yearTolerance of the year
     void removeMovieStub( const SMovieStub &movieStub );
 
     void clearAllMovieStubs();
@@ -134,7 +161,11 @@ Q_SIGNALS:
     void sigSettingsChanged();
     void sigMediaChanged();
 
+private Q_SLOTS:
+    void slotFlushChanges();
+
 private:
+    void queueMediaChanged();
     void removeMovieStub( const std::shared_ptr< CMediaData > &media );
 
     int perServerColumn( int column ) const;
@@ -143,6 +174,12 @@ private:
     std::optional< std::pair< QString, QString > > getProviderInfoForColumn( int column ) const;
 
     void addMediaInfo( const QString &serverName, std::shared_ptr< CMediaData > mediaData, const QJsonObject &mediaInfo );
+    std::shared_ptr< CMediaData > mergeNewMedia( const QString &serverName, const QString &mediaID, const std::shared_ptr< CMediaData > &mediaData );
+
+    void appendMedia( const std::shared_ptr< CMediaData > &media );   // no signals, the caller brackets it with beginInsertRows
+    void removeMediaRow( size_t row );
+    void removeMediaRows( const std::function< bool( const std::shared_ptr< CMediaData > &media ) > &shouldRemove );
+    void reindexRows( size_t firstRow );
     void updateMediaData( std::shared_ptr< CMediaData > mediaData );
 
     QVariant getColor( const QModelIndex &index, const QString &serverName, bool background ) const;
@@ -154,12 +191,18 @@ private:
     std::map< QString, TMediaIDToMediaData > fMediaMap;   // serverName -> mediaID -> mediaData
 
     std::vector< std::shared_ptr< CMediaData > > fData;
-    std::unordered_map< QString, std::shared_ptr< CMediaData > > fDataMap;
-    std::unordered_map< std::shared_ptr< CMediaData >, size_t > fMediaToPos;
+    std::unique_ptr< CMediaNameIndex > fNameIndex;   // every row, keyed by the name keys of its titles and its premiere year
+    std::shared_ptr< CMediaNameIndex > fNameIndexSnapshot;   // the copy the last snapshot handed out, only changed by the thread it was handed to
+    CSeriesIndex fSeriesIndex;   // the episode rows per series and season
+    std::unordered_map< std::shared_ptr< CMediaData >, size_t > fMediaToPos;   // media -> row in fData, kept in step with every row insert and removal
     std::unordered_set< QString > fProviderNames;
     std::unordered_map< int, std::pair< QString, QString > > fProviderColumnsByColumn;
     EDirSort fDirSort{ eNoSort };
 
+    std::unordered_set< std::shared_ptr< CMediaData > > fChangedMedia;   // rows are looked up at flush time, they may move in between
+    bool fMediaChangedPending{ false };
+    QTimer *fFlushChangesTimer{ nullptr };
+
     std::shared_ptr< CServerModel > fServerModel;
     std::shared_ptr< CSettings > fSettings;
 };
@@ -0,0 +1,310 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MediaNameIndex.h"
+#include "MediaData.h"
+#include "TitleNormalizer.h"
+
+#include <algorithm>
+
+CMediaNameIndex::TEntries CMediaNameIndex::entriesFor( const std::shared_ptr< CMediaData > &media )
+{
+    TEntries retVal;
+    auto year = media->premiereDate().year();
+    retVal.emplace_back( media->nameKey(), year );
+    if ( media->originalTitleKey() != media->nameKey() )
+        retVal.emplace_back( media->originalTitleKey(), year );
+    return retVal;
+}
+
+// padded with spaces, so short keys and the word boundaries at either end still produce trigrams
+std::vector< QString > CMediaNameIndex::trigrams( const QString &nameKey )
+{
+    std::vector< QString > retVal;
+    if ( nameKey.isEmpty() )
+        return retVal;
+
+    auto padded = QString( "  %1 " ).arg( nameKey );
+    retVal.reserve( padded.length() - 2 );
+    for ( int ii = 0; ii + 3 <= padded.length(); ++ii )
+        retVal.push_back( padded.mid( ii, 3 ) );
+    std::sort( retVal.begin(), retVal.end() );
+    retVal.erase( std::unique( retVal.begin(), retVal.end() ), retVal.end() );
+    return retVal;
+}
+
+std::vector< QString > CMediaNameIndex::trigrams( const TEntries &entries )
+{
+    std::vector< QString > retVal;
+    for ( auto &&entry : entries )
+    {
+        auto curr = trigrams( entry.first );
+        retVal.insert( retVal.end(), curr.begin(), curr.end() );
+    }
+    std::sort( retVal.begin(), retVal.end() );
+    retVal.erase( std::unique( retVal.begin(), retVal.end() ), retVal.end() );
+    return retVal;
+}
+
+void CMediaNameIndex::add( const std::shared_ptr< CMediaData > &media )
+{
+    if ( !media || ( fEntries.find( media ) != fEntries.end() ) )
+        return;
+
+    insert( media, entriesFor( media ) );
+}
+
+void CMediaNameIndex::insert( const std::shared_ptr< CMediaData > &media, TEntries entries )
+{
+    record( { media, entries } );
+    for ( auto &&entry : entries )
+        fIndex[ entry.first ].emplace( entry.second, media );
+
+    auto &&yearGrams = fTrigrams[ entries.front().second ];
+    for ( auto &&gram : trigrams( entries ) )
+        yearGrams[ gram ].push_back( media );
+
+    fEntries[ media ] = std::move( entries );
+}
+
+void CMediaNameIndex::remove( const std::shared_ptr< CMediaData > &media )
+{
+    auto pos = fEntries.find( media );
+    if ( pos == fEntries.end() )
+        return;
+
+    record( { media, {} } );
+    auto &&entries = ( *pos ).second;
+    for ( auto &&entry : entries )
+    {
+        auto keyPos = fIndex.find( entry.first );
+        if ( keyPos == fIndex.end() )
+            continue;
+
+        auto &&years = ( *keyPos ).second;
+        auto range = years.equal_range( entry.second );
+        for ( auto ii = range.first; ii != range.second; ++ii )
+        {
+            if ( ( *ii ).second == media )
+            {
+                years.erase( ii );
+                break;
+            }
+        }
+        if ( years.empty() )
+            fIndex.erase( keyPos );
+    }
+
+    auto yearPos = fTrigrams.find( entries.front().second );
+    if ( yearPos != fTrigrams.end() )
+    {
+        auto &&yearGrams = ( *yearPos ).second;
+        for ( auto &&gram : trigrams( entries ) )
+        {
+            auto gramPos = yearGrams.find( gram );
+            if ( gramPos == yearGrams.end() )
+                continue;
+
+            auto &&posting = ( *gramPos ).second;
+            auto ii = std::find( posting.begin(), posting.end(), media );
+            if ( ii != posting.end() )
+            {
+                *ii = posting.back();   // the order of a posting does not matter
+                posting.pop_back();
+            }
+            if ( posting.empty() )
+                yearGrams.erase( gramPos );
+        }
+        if ( yearGrams.empty() )
+            fTrigrams.erase( yearPos );
+    }
+
+    fEntries.erase( pos );
+}
+
+void CMediaNameIndex::update( const std::shared_ptr< CMediaData > &media )
+{
+    auto pos = fEntries.find( media );
+    if ( ( pos != fEntries.end() ) && ( ( *pos ).second == entriesFor( media ) ) )
+        return;
+
+    remove( media );
+    add( media );
+}
+
+void CMediaNameIndex::clear()
+{
+    fIndex.clear();
+    fEntries.clear();
+    fTrigrams.clear();
+    if ( fRecording )
+    {
+        fChanges.clear();   // nothing recorded before a clear survives it
+        fChanges.push_back( {} );
+    }
+}
+
+void CMediaNameIndex::recordChanges( bool record )
+{
+    fRecording = record;
+    fChanges.clear();
+}
+
+std::optional< CMediaNameIndex::TChanges > CMediaNameIndex::takeChanges()
+{
+    if ( !fRecording )
+        return {};
+    TChanges retVal;
+    std::swap( retVal, fChanges );
+    return retVal;
+}
+
+void CMediaNameIndex::record( SChange change )
+{
+    if ( !fRecording )
+        return;
+    if ( fChanges.size() > ( 2 * fEntries.size() + 1024 ) )
+    {
+        recordChanges( false );
+        return;
+    }
+    fChanges.push_back( std::move( change ) );
+}
+
+void CMediaNameIndex::apply( const TChanges &changes )
+{
+    for ( auto &&change : changes )
+    {
+        if ( !change.fMedia )
+            clear();
+        else
+        {
+            remove( change.fMedia );
+            if ( !change.fEntries.empty() )
+                insert( change.fMedia, change.fEntries );
+        }
+    }
+}
+
+bool CMediaNameIndex::forEach( const QString &nameKey, std::optional< int > year, int yearTolerance, const TAcceptFunc &func ) const
+{
+    auto pos = fIndex.find( nameKey );
+    if ( pos == fIndex.end() )
+        return false;
+
+    auto &&years = ( *pos ).second;
+    auto begin = year.has_value() ? years.lower_bound( year.value() - yearTolerance ) : years.begin();
+    auto end = year.has_value() ? years.upper_bound( year.value() + yearTolerance ) : years.end();
+    for ( auto ii = begin; ii != end; ++ii )
+    {
+        if ( func( ( *ii ).second ) )
+            return true;
+    }
+    return false;
+}
+
+std::shared_ptr< CMediaData > CMediaNameIndex::find( const QString &nameKey, std::optional< int > year, int yearTolerance, const TAcceptFunc &accept ) const
+{
+    std::shared_ptr< CMediaData > retVal;
+    forEach(
+        nameKey, year, yearTolerance,
+        [ &retVal, &accept ]( const std::shared_ptr< CMediaData > &media )
+        {
+            if ( accept && !accept( media ) )
+                return false;
+            retVal = media;
+            return true;
+        } );
+    return retVal;
+}
+
+std::vector< std::shared_ptr< CMediaData > > CMediaNameIndex::findAll( const QString &nameKey, std::optional< int > year, int yearTolerance ) const
+{
+    std::vector< std::shared_ptr< CMediaData > > retVal;
+    forEach(
+        nameKey, year, yearTolerance,
+        [ &retVal ]( const std::shared_ptr< CMediaData > &media )
+        {
+            if ( std::find( retVal.begin(), retVal.end(), media ) == retVal.end() )   // the name and original title can both match
+                retVal.push_back( media );
+            return false;
+        } );
+    return retVal;
+}
+
+std::vector< std::shared_ptr< CMediaData > > CMediaNameIndex::similarCandidates( const QString &nameKey, int year, int yearTolerance, size_t maxCandidates ) const
+{
+    auto grams = trigrams( nameKey );
+    if ( grams.empty() )
+        return {};
+
+    std::unordered_map< std::shared_ptr< CMediaData >, int > shared;
+    for ( auto currYear = year - yearTolerance; currYear <= year + yearTolerance; ++currYear )
+    {
+        auto yearPos = fTrigrams.find( currYear );
+        if ( yearPos == fTrigrams.end() )
+            continue;
+
+        for ( auto &&gram : grams )
+        {
+            auto gramPos = ( *yearPos ).second.find( gram );
+            if ( gramPos == ( *yearPos ).second.end() )
+                continue;
+            for ( auto &&media : ( *gramPos ).second )
+                shared[ media ]++;
+        }
+    }
+
+    auto minShared = std::max( 1, static_cast< int >( grams.size() + 2 ) / 3 );
+    std::vector< std::pair< int, std::shared_ptr< CMediaData > > > ranked;
+    for ( auto &&ii : shared )
+    {
+        if ( ii.second >= minShared )
+            ranked.emplace_back( ii.second, ii.first );
+    }
+
+    auto numRanked = std::min( maxCandidates, ranked.size() );
+    std::partial_sort( ranked.begin(), ranked.begin() + numRanked, ranked.end(), []( const auto &lhs, const auto &rhs ) { return lhs.first > rhs.first; } );
+
+    std::vector< std::shared_ptr< CMediaData > > retVal;
+    retVal.reserve( numRanked );
+    for ( size_t ii = 0; ii < numRanked; ++ii )
+        retVal.push_back( ranked[ ii ].second );
+    return retVal;
+}
+
+std::shared_ptr< CMediaData > CMediaNameIndex::findMatch( const QString &name, int year, int yearTolerance ) const
+{
+    auto isServerMedia = []( const std::shared_ptr< CMediaData > &media ) { return !media->isMovieStub(); };
+
+    auto nameKey = CTitleNormalizer::key( name );
+    auto retVal = find( nameKey, year, yearTolerance, isServerMedia );
+    if ( retVal )
+        return retVal;
+
+    for ( auto &&ii : similarCandidates( nameKey, year, yearTolerance, 32 ) )
+    {
+        if ( isServerMedia( ii ) && ii->isNameMatch( name, nameKey ) )
+            return ii;
+    }
+    return {};
+}
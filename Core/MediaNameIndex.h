@@ -0,0 +1,98 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MEDIANAMEINDEX_H
+#define __MEDIANAMEINDEX_H
+
+#include <QString>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+class CMediaData;
+
+// name key -> premiere year -> media, both the name and the original title of an item are indexed
+// lookups touch only the items sharing the name key, the year range is a walk over an ordered bucket
+// for fuzzy lookups the trigrams of the keys are indexed per premiere year, similarCandidates ranks the items of the
+// year buckets by the trigrams they share with the query, the expensive similarity check only runs on the best few
+class CMediaNameIndex
+{
+public:
+    using TAcceptFunc = std::function< bool( const std::shared_ptr< CMediaData > &media ) >;
+    using TEntries = std::vector< std::pair< QString, int > >;
+
+    // a null media is a clear, no entries a removal, otherwise the media is (re)added under the entries
+    // the entries are taken when the change is made, replaying a change never reads the media
+    struct SChange
+    {
+        std::shared_ptr< CMediaData > fMedia;
+        TEntries fEntries;
+    };
+    using TChanges = std::vector< SChange >;
+
+    void add( const std::shared_ptr< CMediaData > &media );
+    void remove( const std::shared_ptr< CMediaData > &media );   // removes the keys the media was added with, even if its name changed since
+    void update( const std::shared_ptr< CMediaData > &media );   // re-indexes the media only when its keys or premiere year changed
+    void clear();
+
+    // an unset year matches any year, otherwise the premiere year has to be within yearTolerance of it
+    std::shared_ptr< CMediaData > find( const QString &nameKey, std::optional< int > year, int yearTolerance = 0, const TAcceptFunc &accept = {} ) const;
+    std::vector< std::shared_ptr< CMediaData > > findAll( const QString &nameKey, std::optional< int > year, int yearTolerance = 0 ) const;
+
+    // the media within yearTolerance of year sharing at least a third of the trigrams of nameKey, most shared first
+    std::vector< std::shared_ptr< CMediaData > > similarCandidates( const QString &nameKey, int year, int yearTolerance, size_t maxCandidates ) const;
+
+    // the server media (never a movie stub) a listed movie refers to, an exact name key first then the similar candidates
+    // only the indexed years and the titles, which never change, are read so a copy of the index can be searched from worker threads
+    std::shared_ptr< CMediaData > findMatch( const QString &name, int year, int yearTolerance ) const;
+
+    size_t size() const { return fEntries.size(); }
+
+    // lets a copy of the index be kept current by replaying the changes made since it was taken
+    // recording stops once replaying would cost more than a new copy, takeChanges then has nothing to hand out
+    void recordChanges( bool record );
+    std::optional< TChanges > takeChanges();
+    void apply( const TChanges &changes );
+
+private:
+    using TYearMap = std::multimap< int, std::shared_ptr< CMediaData > >;
+    static TEntries entriesFor( const std::shared_ptr< CMediaData > &media );
+    static std::vector< QString > trigrams( const QString &nameKey );
+    static std::vector< QString > trigrams( const TEntries &entries );   // the union over the keys of an item
+
+    void insert( const std::shared_ptr< CMediaData > &media, TEntries entries );
+    void record( SChange change );
+
+    bool forEach( const QString &nameKey, std::optional< int > year, int yearTolerance, const TAcceptFunc &func ) const;   // stops and returns true once func does
+
+    std::unordered_map< QString, TYearMap > fIndex;
+    std::unordered_map< std::shared_ptr< CMediaData >, TEntries > fEntries;   // media -> the (key, year) pairs it was indexed under
+    std::unordered_map< int, std::unordered_map< QString, std::vector< std::shared_ptr< CMediaData > > > > fTrigrams;   // year -> trigram -> media
+
+    bool fRecording{ false };
+    TChanges fChanges;
+};
+#endif
@@ -4,8 +4,10 @@
 
 #include <QString>
 
+#include <algorithm>
 #include <map>
 #include <optional>
+#include <vector>
 
 #include <QDebug>
 
@@ -14,12 +16,6 @@ using TMediaIDToMediaData = std::map< QString, std::shared_ptr< CMediaData > >;
 void CMergeMedia::addMediaInfo( const QString &serverName, std::shared_ptr< CMediaData > mediaData )
 {
     fMediaMap[ serverName ][ mediaData->getMediaID( serverName ) ] = mediaData;
-
-    auto &&providers = mediaData->getProviders( true );
-    for ( auto &&ii : providers )
-    {
-        fProviderSearchMap[ serverName ][ ii.first ][ ii.second ] = mediaData;
-    }
 }
 
 void CMergeMedia::removeMedia( const QString &serverName, const std::shared_ptr< CMediaData > &mediaData )
@@ -28,32 +24,145 @@ void CMergeMedia::removeMedia( const QString &serverName, const std::shared_ptr<
     if ( pos != fMediaMap.end() )
     {
         auto pos2 = ( *pos ).second.find( mediaData->getMediaID( serverName ) );
-        ( *pos ).second.erase( pos2 );
+        if ( pos2 != ( *pos ).second.end() )
+            ( *pos ).second.erase( pos2 );
+    }
+}
+
+namespace
+{
+    // the keys merge joins on, the provider IDs or the type and name when the media has none
+    std::vector< std::pair< QString, QString > > mergeKeys( const std::shared_ptr< CMediaData > &mediaData )
+    {
+        std::vector< std::pair< QString, QString > > retVal;
+        auto &&providers = mediaData->providers();
+        if ( providers.empty() )
+            retVal.emplace_back( mediaData->mediaType(), mediaData->name() );
+        for ( auto &&provider : providers )
+        {
+            if ( !provider.second.isEmpty() )
+                retVal.push_back( provider );
+        }
+        return retVal;
     }
 
-    auto &&providers = mediaData->getProviders( true );
-    for ( auto &&ii : providers )
+    // one entry per loaded item, the items that are the same media on different servers form a union-find set
+    struct SMergeItem
+    {
+        int fServer{ 0 };
+        std::shared_ptr< CMediaData > *fSlot{ nullptr };   // the items entry in the media map, replaced by the merged media
+        int fParent{ 0 };
+        int fNext{ 0 };   // circular list of the members of the set
+        int fFirst{ 0 };   // valid on the root, the first loaded member which all others are merged into
+        int fSize{ 1 };   // valid on the root
+    };
+
+    class CMergeJoin
     {
-        auto pos = fProviderSearchMap.find( serverName );
-        if ( pos != fProviderSearchMap.end() )
+    public:
+        CMergeJoin( size_t numItems ) { fItems.reserve( numItems ); }
+
+        int addItem( int server, std::shared_ptr< CMediaData > *slot )
         {
-            auto pos2 = ( *pos ).second.find( ii.first );
-            if ( pos2 != ( *pos ).second.end() )
+            auto itemNum = static_cast< int >( fItems.size() );
+            fItems.push_back( { server, slot, itemNum, itemNum, itemNum, 1 } );
+            return itemNum;
+        }
+
+        // provider name and ID pairs are interned to integers so each comparison after the first lookup is an int compare
+        int internKey( const QString &providerName, const QString &providerID )
+        {
+            auto &&ids = fKeyIDs[ providerName ];
+            auto pos = ids.find( providerID );
+            if ( pos != ids.end() )
+                return ( *pos ).second;
+
+            auto keyNum = static_cast< int >( fKeyOwner.size() );
+            ids[ providerID ] = keyNum;
+            fKeyOwner.push_back( -1 );
+            return keyNum;
+        }
+
+        int find( int itemNum )
+        {
+            while ( fItems[ itemNum ].fParent != itemNum )
             {
-                auto pos3 = ( *pos2 ).second.find( ii.second );
-                if ( pos3 != ( *pos2 ).second.end() )
-                    ( *pos2 ).second.erase( pos3 );
-                if ( ( *pos2 ).second.empty() )
-                {
-                    ( *pos ).second.erase( pos2 );
-                }
+                fItems[ itemNum ].fParent = fItems[ fItems[ itemNum ].fParent ].fParent;
+                itemNum = fItems[ itemNum ].fParent;
             }
-            if ( ( *pos ).second.empty() )
+            return itemNum;
+        }
+
+        bool containsServer( int root, int server ) const
+        {
+            auto curr = root;
+            do
             {
-                fProviderSearchMap.erase( serverName );
+                if ( fItems[ curr ].fServer == server )
+                    return true;
+                curr = fItems[ curr ].fNext;
             }
+            while ( curr != root );
+            return false;
         }
-    }
+
+        void unite( int lhs, int rhs )
+        {
+            lhs = find( lhs );
+            rhs = find( rhs );
+            if ( lhs == rhs )
+                return;
+
+            if ( fItems[ lhs ].fSize < fItems[ rhs ].fSize )
+                std::swap( lhs, rhs );
+
+            fItems[ rhs ].fParent = lhs;
+            fItems[ lhs ].fSize += fItems[ rhs ].fSize;
+            fItems[ lhs ].fFirst = std::min( fItems[ lhs ].fFirst, fItems[ rhs ].fFirst );
+            std::swap( fItems[ lhs ].fNext, fItems[ rhs ].fNext );
+        }
+
+        // joins the item to the set most of its provider IDs point to, sets that already have media from the items server are skipped
+        void join( int itemNum, const std::vector< int > &keys )
+        {
+            fVotes.clear();
+            for ( auto &&key : keys )
+            {
+                auto owner = fKeyOwner[ key ];
+                if ( owner < 0 )
+                    continue;
+
+                auto root = find( owner );
+                if ( containsServer( root, fItems[ itemNum ].fServer ) )
+                    continue;
+
+                auto pos = std::find_if( fVotes.begin(), fVotes.end(), [ root ]( const std::pair< int, int > &vote ) { return vote.first == root; } );
+                if ( pos == fVotes.end() )
+                    fVotes.emplace_back( root, 1 );
+                else
+                    ( *pos ).second++;
+            }
+
+            if ( !fVotes.empty() )
+            {
+                auto winner = std::max_element( fVotes.begin(), fVotes.end(), []( const std::pair< int, int > &lhs, const std::pair< int, int > &rhs ) { return lhs.second < rhs.second; } );
+                unite( ( *winner ).first, itemNum );
+            }
+
+            for ( auto &&key : keys )
+            {
+                if ( fKeyOwner[ key ] < 0 )
+                    fKeyOwner[ key ] = itemNum;
+            }
+        }
+
+        std::vector< SMergeItem > fItems;
+
+    private:
+        std::unordered_map< QString, std::unordered_map< QString, int > > fKeyIDs;   // provider name -> provider ID -> interned key
+        std::vector< int > fKeyOwner;   // interned key -> first item with that key
+        std::vector< std::pair< int, int > > fVotes;   // set root -> number of matching keys
+    };
 }
 
 bool CMergeMedia::merge( std::shared_ptr< CProgressSystem > progressSystem )
@@ -65,101 +174,60 @@ bool CMergeMedia::merge( std::shared_ptr< CProgressSystem > progressSystem )
     {
         total += ii.second.size();
     }
-    progressSystem->setMaximum( static_cast< int >( total * 3 ) );
+    progressSystem->setMaximum( static_cast< int >( total * 2 ) );
 
-    for ( auto &&ii = fMediaMap.begin(); ii != fMediaMap.end(); ++ii )
+    // single sweep over every server, each item is joined with the already seen media sharing its provider IDs
+    CMergeJoin join( total );
+    std::vector< QString > serverNames;
+    std::vector< int > keys;
+    for ( auto &&ii : fMediaMap )
     {
         if ( progressSystem->wasCanceled() )
             break;
 
-        for ( auto jj = ii; jj != fMediaMap.end(); ++jj )
+        auto serverNum = static_cast< int >( serverNames.size() );
+        serverNames.push_back( ii.first );
+        for ( auto &&jj : ii.second )
         {
-            if ( ii == jj )
-                continue;
-
-            merge( ( *ii ), ( *jj ), progressSystem );
             if ( progressSystem->wasCanceled() )
                 break;
 
-            merge( ( *jj ), ( *ii ), progressSystem );
-            if ( progressSystem->wasCanceled() )
-                break;
+            progressSystem->incProgress();
+            auto &&mediaData = jj.second;
+            if ( !mediaData )
+                continue;
+
+            keys.clear();
+            for ( auto &&key : mergeKeys( mediaData ) )
+                keys.push_back( join.internKey( key.first, key.second ) );
+
+            join.join( join.addItem( serverNum, &jj.second ), keys );
         }
     }
 
-    fProviderSearchMap.clear();
-
     if ( progressSystem->wasCanceled() )
+    {
         clear();
-    return !progressSystem->wasCanceled();
-}
-
-void CMergeMedia::merge( std::pair< const QString, TMediaIDToMediaData > &lhs, std::pair< const QString, TMediaIDToMediaData > &rhs, std::shared_ptr< CProgressSystem > progressSystem )
-{
-    // qDebug() << lhs.first << rhs.first;
-
-    merge( lhs, progressSystem );
-    merge( rhs, progressSystem );
-}
+        return false;
+    }
 
-void CMergeMedia::merge( std::pair< const QString, TMediaIDToMediaData > &mapData, std::shared_ptr< CProgressSystem > progressSystem )
-{
-    // qDebug() << mapData.first;
-    std::unordered_map< std::shared_ptr< CMediaData >, std::shared_ptr< CMediaData > > replacementMap;
-    for ( auto &&ii : mapData.second )
+    fProviderIndex.clear();
+    for ( int ii = 0; ii < static_cast< int >( join.fItems.size() ); ++ii )
     {
-        if ( progressSystem->wasCanceled() )
-            break;
-
-        progressSystem->incProgress();
-        auto mediaData = ii.second;
-        if ( !mediaData )
-            continue;
+        auto first = join.fItems[ join.find( ii ) ].fFirst;
+        auto &&item = join.fItems[ ii ];
+        auto &&merged = *join.fItems[ first ].fSlot;
 
-        auto mediaProviders = mediaData->getProviders( true );
-        auto myMappedMedia = findMediaForProviders( mapData.first, mediaProviders );
-        if ( myMappedMedia && ( myMappedMedia != mediaData ) )
-        {
-            replacementMap[ mediaData ] = myMappedMedia;
+        // indexed before the slot is replaced so every items own keys point at the merged media
+        indexMedia( merged, *item.fSlot );
+        if ( first == ii )
             continue;
-        }
 
-        for ( auto &&ii : fProviderSearchMap )
-        {
-            if ( ii.first == mapData.first )
-                continue;
-
-            auto otherData = findMediaForProviders( ii.first, mediaProviders );
-            if ( otherData != mediaData )
-                setMediaForProviders( ii.first, mediaProviders, mediaData );
-        }
+        merged->updateFromOther( serverNames[ item.fServer ], *item.fSlot );
+        *item.fSlot = merged;
     }
-    for ( auto &&ii : replacementMap )
-    {
-        auto currMediaID = ii.first->getMediaID( mapData.first );
-        auto pos = mapData.second.find( currMediaID );
-        mapData.second.erase( pos );
-
-        ii.second->updateFromOther( mapData.first, ii.first );
-        mapData.second[ currMediaID ] = ii.second;
-    }
-}
-
-QStringList CMergeMedia::getOtherServers( const QString &serverName ) const
-{
-    QStringList otherServers;
-    for ( auto &&ii : fProviderSearchMap )
-    {
-        if ( ii.first != serverName )
-            otherServers << ii.first;
-    }
-    return otherServers;
-}
-
-void CMergeMedia::clear()
-{
-    fMediaMap.clear();
-    fProviderSearchMap.clear();
+    fMerged = true;
+    return true;
 }
 
 std::pair< std::unordered_set< std::shared_ptr< CMediaData > >, std::map< QString, TMediaIDToMediaData > > CMergeMedia::getMergedData( std::shared_ptr< CProgressSystem > progressSystem ) const
@@ -178,63 +246,86 @@ std::pair< std::unordered_set< std::shared_ptr< CMediaData > >, std::map< QStrin
     return { allMedia, fMediaMap };
 }
 
-std::shared_ptr< CMediaData > CMergeMedia::findMediaForProviders( const QString &serverName, const std::map< QString, QString > &providerIDs ) const
+void CMergeMedia::clear()
+{
+    fMediaMap.clear();
+    fProviderIndex.clear();
+    fMerged = false;
+}
+
+// the key owners are kept, like the full merge the first media seen with a key owns it
+void CMergeMedia::indexMedia( const std::shared_ptr< CMediaData > &mergedData, const std::shared_ptr< CMediaData > &keySource )
 {
-    auto pos = fProviderSearchMap.find( serverName );
-    if ( pos == fProviderSearchMap.end() )
-        return {};
+    for ( auto &&key : mergeKeys( keySource ) )
+        fProviderIndex[ key.first ].emplace( key.second, mergedData );
+}
 
-    std::map< std::shared_ptr< CMediaData >, int > mapCount;
+// only the keys of the merged media itself, keys from the other servers items are dropped when a lookup finds them stale
+void CMergeMedia::unindexMedia( const std::shared_ptr< CMediaData > &mergedData )
+{
+    for ( auto &&key : mergeKeys( mergedData ) )
+    {
+        auto pos = fProviderIndex.find( key.first );
+        if ( pos == fProviderIndex.end() )
+            continue;
+        auto pos2 = ( *pos ).second.find( key.second );
+        if ( ( pos2 != ( *pos ).second.end() ) && ( ( *pos2 ).second == mergedData ) )
+            ( *pos ).second.erase( pos2 );
+    }
+}
 
-    for ( auto &&ii : providerIDs )
+// the same vote as the full merge, the media most of the items keys point to wins, media already on the items server is skipped
+std::shared_ptr< CMediaData > CMergeMedia::mergeItem( const QString &serverName, const std::shared_ptr< CMediaData > &mediaData, bool &isNew )
+{
+    std::vector< std::pair< std::shared_ptr< CMediaData >, int > > votes;
+    for ( auto &&key : mergeKeys( mediaData ) )
     {
-        if ( ii.second.isEmpty() )
+        auto pos = fProviderIndex.find( key.first );
+        if ( pos == fProviderIndex.end() )
             continue;
-        auto currMedia = findMediaForProvider( ( *pos ).second, ii.first, ii.second );
-        if ( !currMedia )
+        auto pos2 = ( *pos ).second.find( key.second );
+        if ( pos2 == ( *pos ).second.end() )
             continue;
 
-        mapCount[ currMedia ]++;
-    }
+        auto candidate = ( *pos2 ).second;
+        if ( !candidate->isValidForAnyServer() )
+        {
+            ( *pos ).second.erase( pos2 );   // removed from every server
+            continue;
+        }
+        if ( ( candidate == mediaData ) || candidate->isValidForServer( serverName ) )
+            continue;
 
-    if ( mapCount.size() == 1 )
-        return ( *mapCount.begin() ).first;
+        auto vote = std::find_if( votes.begin(), votes.end(), [ &candidate ]( const std::pair< std::shared_ptr< CMediaData >, int > &ii ) { return ii.first == candidate; } );
+        if ( vote == votes.end() )
+            votes.emplace_back( candidate, 1 );
+        else
+            ( *vote ).second++;
+    }
 
-    int max = 0;
-    std::shared_ptr< CMediaData > retVal;
-    for ( auto &&ii : mapCount )
+    auto merged = mediaData;
+    isNew = votes.empty();
+    if ( !isNew )
     {
-        if ( ii.second > max )
-        {
-            max = ii.second;
-            retVal = ii.first;
-        }
+        merged = ( *std::max_element( votes.begin(), votes.end(), []( const std::pair< std::shared_ptr< CMediaData >, int > &lhs, const std::pair< std::shared_ptr< CMediaData >, int > &rhs ) { return lhs.second < rhs.second; } ) ).first;
+        merged->updateFromOther( serverName, mediaData );
     }
-    return retVal;
-}
 
-std::shared_ptr< CMediaData > CMergeMedia::findMediaForProvider( const std::unordered_map< QString, std::unordered_map< QString, std::shared_ptr< CMediaData > > > &map, const QString &provider, const QString &id ) const
-{
-    auto pos = map.find( provider );
-    if ( pos == map.end() )
-        return {};
-
-    auto pos2 = ( *pos ).second.find( id );
-    if ( pos2 == ( *pos ).second.end() )
-        return {};
-    return ( *pos2 ).second;
+    fMediaMap[ serverName ][ mediaData->getMediaID( serverName ) ] = merged;
+    indexMedia( merged, mediaData );
+    return merged;
 }
 
-void CMergeMedia::setMediaForProviders( const QString &serverName, const std::map< QString, QString > &providerIDs, std::shared_ptr< CMediaData > mediaData )
+bool CMergeMedia::removeItem( const QString &serverName, const std::shared_ptr< CMediaData > &mergedData )
 {
-    auto pos = fProviderSearchMap.find( serverName );
-    if ( pos == fProviderSearchMap.end() )
-        pos = fProviderSearchMap.insert( std::make_pair( serverName, std::unordered_map< QString, std::unordered_map< QString, std::shared_ptr< CMediaData > > >() ) ).first;
+    auto pos = fMediaMap.find( serverName );
+    if ( pos != fMediaMap.end() )
+        ( *pos ).second.erase( mergedData->getMediaID( serverName ) );
 
-    for ( auto &&ii : providerIDs )
-    {
-        if ( ii.second.isEmpty() )
-            continue;
-        ( *pos ).second[ ii.first ][ ii.second ] = mediaData;
-    }
+    mergedData->clearServerData( serverName );
+    if ( mergedData->isValidForAnyServer() )
+        return false;
+
+    unindexMedia( mergedData );
+    return true;
 }
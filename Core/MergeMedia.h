@@ -26,20 +26,18 @@ public:
 
     std::pair< std::unordered_set< std::shared_ptr< CMediaData > >, std::map< QString, TMediaIDToMediaData > > getMergedData( std::shared_ptr< CProgressSystem > progressSystem ) const;
 
-private:
-    void merge( std::pair< const QString, TMediaIDToMediaData > &lhs, std::pair< const QString, TMediaIDToMediaData > &rhs, std::shared_ptr< CProgressSystem > progressSystem );
-    void merge( std::pair< const QString, TMediaIDToMediaData > &mapData, std::shared_ptr< CProgressSystem > progressSystem );
-
-    QStringList getOtherServers( const QString &serverName ) const;
+    // incremental updates once merge has run, each costs a lookup per provider ID of the item
+    bool isMerged() const { return fMerged; }
+    std::shared_ptr< CMediaData > mergeItem( const QString &serverName, const std::shared_ptr< CMediaData > &mediaData, bool &isNew );   // returns the merged media the item is now part of, isNew when it matched no other server
+    bool removeItem( const QString &serverName, const std::shared_ptr< CMediaData > &mergedData );   // true when no server has the media anymore
 
-    std::shared_ptr< CMediaData > findMediaForProviders( const QString &serverName, const std::map< QString, QString > &providerIDs ) const;
-    std::shared_ptr< CMediaData > findMediaForProvider( const std::unordered_map< QString, std::unordered_map< QString, std::shared_ptr< CMediaData > > > &map, const QString &provider, const QString &id ) const;
-    void setMediaForProviders( const QString &serverName, const std::map< QString, QString > &providerIDs, std::shared_ptr< CMediaData > mediaData );
+private:
+    void indexMedia( const std::shared_ptr< CMediaData > &mergedData, const std::shared_ptr< CMediaData > &keySource );
+    void unindexMedia( const std::shared_ptr< CMediaData > &mergedData );
 
     std::map< QString, TMediaIDToMediaData > fMediaMap;   // serverName -> mediaID -> mediaData
-
-    // provider name -> provider ID -> mediaData
-    std::map< QString, std::unordered_map< QString, std::unordered_map< QString, std::shared_ptr< CMediaData > > > > fProviderSearchMap;   // servername -> provider name, to map of id to mediadata
+    std::unordered_map< QString, std::unordered_map< QString, std::shared_ptr< CMediaData > > > fProviderIndex;   // provider name -> provider ID -> merged media, filled by merge
+    bool fMerged{ false };
 };
 
 #endif
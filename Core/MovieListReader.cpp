@@ -0,0 +1,790 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MovieListReader.h"
+#include "MediaData.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonValue>
+#include <QObject>
+#include <QStringList>
+
+#include <algorithm>
+#include <optional>
+
+namespace NJSON
+{
+    // the file is read in fixed size chunks
+    class CByteSource
+    {
+    public:
+        CByteSource( QIODevice *device ) :
+            fDevice( device )
+        {
+        }
+
+        int peek()
+        {
+            if ( ( fPos >= fBuffer.size() ) && !fill() )
+                return -1;
+            return static_cast< unsigned char >( fBuffer[ fPos ] );
+        }
+
+        int get()
+        {
+            auto retVal = peek();
+            if ( retVal != -1 )
+            {
+                ++fPos;
+                ++fOffset;
+            }
+            return retVal;
+        }
+
+        qint64 offset() const { return fOffset; }
+
+    private:
+        bool fill()
+        {
+            static const qint64 kChunkSize = 64 * 1024;
+            fBuffer = fDevice->read( kChunkSize );
+            fPos = 0;
+            return !fBuffer.isEmpty();
+        }
+
+        QIODevice *fDevice{ nullptr };
+        QByteArray fBuffer;
+        int fPos{ 0 };
+        qint64 fOffset{ 0 };
+    };
+}
+
+namespace
+{
+    class IJsonHandler
+    {
+    public:
+        virtual ~IJsonHandler() {}
+        virtual void startObject() = 0;
+        virtual void endObject() = 0;
+        virtual void startArray() = 0;
+        virtual void endArray() = 0;
+        virtual void key( const QString &key ) = 0;
+        virtual void value( const QJsonValue &value ) = 0;
+    };
+
+    // SAX style json parser, reports the structure to the handler as it reads, nothing is kept once reported
+    class CJsonTokenizer
+    {
+    public:
+        CJsonTokenizer( NJSON::CByteSource &source, IJsonHandler &handler ) :
+            fSource( source ),
+            fHandler( handler )
+        {
+        }
+
+        bool atEnd()
+        {
+            skipWhitespace();
+            return fSource.peek() == -1;
+        }
+
+        bool parseValue()
+        {
+            skipWhitespace();
+            switch ( fSource.peek() )
+            {
+                case '{':
+                    return parseObject();
+                case '[':
+                    return parseArray();
+                case '"':
+                {
+                    QString value;
+                    if ( !parseString( value ) )
+                        return false;
+                    fHandler.value( value );
+                    return true;
+                }
+                case 't':
+                    return parseLiteral( "true", QJsonValue( true ) );
+                case 'f':
+                    return parseLiteral( "false", QJsonValue( false ) );
+                case 'n':
+                    return parseLiteral( "null", QJsonValue() );
+                case -1:
+                    return fail( QObject::tr( "unexpected end of file" ) );
+                default:
+                    return parseNumber();
+            }
+        }
+
+        QString errorString() const { return QString( "Error: %1 @ %2" ).arg( fError ).arg( fErrorOffset ); }
+
+    private:
+        bool fail( const QString &error )
+        {
+            fError = error;
+            fErrorOffset = fSource.offset();
+            return false;
+        }
+
+        void skipWhitespace()
+        {
+            for ( auto ch = fSource.peek(); ( ch == ' ' ) || ( ch == '\t' ) || ( ch == '\n' ) || ( ch == '\r' ); ch = fSource.peek() )
+                fSource.get();
+        }
+
+        bool expect( char expected )
+        {
+            skipWhitespace();
+            if ( fSource.get() != expected )
+                return fail( QObject::tr( "expected '%1'" ).arg( expected ) );
+            return true;
+        }
+
+        bool parseObject()
+        {
+            if ( ++fDepth > kMaxDepth )
+                return fail( QObject::tr( "nested too deeply" ) );
+
+            fSource.get();
+            fHandler.startObject();
+            skipWhitespace();
+            if ( fSource.peek() == '}' )
+                fSource.get();
+            else
+            {
+                while ( true )
+                {
+                    skipWhitespace();
+                    if ( fSource.peek() != '"' )
+                        return fail( QObject::tr( "expected a key" ) );
+
+                    QString key;
+                    if ( !parseString( key ) || !expect( ':' ) )
+                        return false;
+                    fHandler.key( key );
+                    if ( !parseValue() )
+                        return false;
+
+                    skipWhitespace();
+                    auto ch = fSource.get();
+                    if ( ch == '}' )
+                        break;
+                    if ( ch != ',' )
+                        return fail( QObject::tr( "expected ',' or '}'" ) );
+                }
+            }
+            fHandler.endObject();
+            --fDepth;
+            return true;
+        }
+
+        bool parseArray()
+        {
+            if ( ++fDepth > kMaxDepth )
+                return fail( QObject::tr( "nested too deeply" ) );
+
+            fSource.get();
+            fHandler.startArray();
+            skipWhitespace();
+            if ( fSource.peek() == ']' )
+                fSource.get();
+            else
+            {
+                while ( true )
+                {
+                    if ( !parseValue() )
+                        return false;
+
+                    skipWhitespace();
+                    auto ch = fSource.get();
+                    if ( ch == ']' )
+                        break;
+                    if ( ch != ',' )
+                        return fail( QObject::tr( "expected ',' or ']'" ) );
+                }
+            }
+            fHandler.endArray();
+            --fDepth;
+            return true;
+        }
+
+        static void appendUtf8( QByteArray &utf8, uint codePoint )
+        {
+            if ( codePoint < 0x80 )
+                utf8 += static_cast< char >( codePoint );
+            else if ( codePoint < 0x800 )
+            {
+                utf8 += static_cast< char >( 0xC0 | ( codePoint >> 6 ) );
+                utf8 += static_cast< char >( 0x80 | ( codePoint & 0x3F ) );
+            }
+            else if ( codePoint < 0x10000 )
+            {
+                utf8 += static_cast< char >( 0xE0 | ( codePoint >> 12 ) );
+                utf8 += static_cast< char >( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+                utf8 += static_cast< char >( 0x80 | ( codePoint & 0x3F ) );
+            }
+            else
+            {
+                utf8 += static_cast< char >( 0xF0 | ( codePoint >> 18 ) );
+                utf8 += static_cast< char >( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) );
+                utf8 += static_cast< char >( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+                utf8 += static_cast< char >( 0x80 | ( codePoint & 0x3F ) );
+            }
+        }
+
+        std::optional< uint > parseHex4()
+        {
+            uint retVal = 0;
+            for ( int ii = 0; ii < 4; ++ii )
+            {
+                auto ch = fSource.get();
+                retVal <<= 4;
+                if ( ( ch >= '0' ) && ( ch <= '9' ) )
+                    retVal |= ch - '0';
+                else if ( ( ch >= 'a' ) && ( ch <= 'f' ) )
+                    retVal |= ch - 'a' + 10;
+                else if ( ( ch >= 'A' ) && ( ch <= 'F' ) )
+                    retVal |= ch - 'A' + 10;
+                else
+                    return {};
+            }
+            return retVal;
+        }
+
+        // the raw bytes are collected and decoded once, so a multi byte character split across chunks is not an issue
+        bool parseString( QString &value )
+        {
+            fSource.get();
+            QByteArray utf8;
+            while ( true )
+            {
+                auto ch = fSource.get();
+                if ( ch == -1 )
+                    return fail( QObject::tr( "unterminated string" ) );
+                if ( ch == '"' )
+                    break;
+                if ( ch != '\\' )
+                {
+                    utf8 += static_cast< char >( ch );
+                    continue;
+                }
+
+                ch = fSource.get();
+                switch ( ch )
+                {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        utf8 += static_cast< char >( ch );
+                        break;
+                    case 'b':
+                        utf8 += '\b';
+                        break;
+                    case 'f':
+                        utf8 += '\f';
+                        break;
+                    case 'n':
+                        utf8 += '\n';
+                        break;
+                    case 'r':
+                        utf8 += '\r';
+                        break;
+                    case 't':
+                        utf8 += '\t';
+                        break;
+                    case 'u':
+                    {
+                        auto codePoint = parseHex4();
+                        if ( !codePoint.has_value() )
+                            return fail( QObject::tr( "invalid unicode escape" ) );
+
+                        auto value = codePoint.value();
+                        if ( ( value >= 0xD800 ) && ( value < 0xDC00 ) )
+                        {
+                            std::optional< uint > low;
+                            if ( ( fSource.get() == '\\' ) && ( fSource.get() == 'u' ) )
+                                low = parseHex4();
+                            if ( !low.has_value() || ( low.value() < 0xDC00 ) || ( low.value() >= 0xE000 ) )
+                                return fail( QObject::tr( "invalid surrogate pair" ) );
+                            value = 0x10000 + ( ( value - 0xD800 ) << 10 ) + ( low.value() - 0xDC00 );
+                        }
+                        appendUtf8( utf8, value );
+                        break;
+                    }
+                    default:
+                        return fail( QObject::tr( "invalid escape" ) );
+                }
+            }
+            value = QString::fromUtf8( utf8 );
+            return true;
+        }
+
+        bool parseNumber()
+        {
+            QByteArray number;
+            for ( auto ch = fSource.peek(); ( ( ch >= '0' ) && ( ch <= '9' ) ) || ( ch == '-' ) || ( ch == '+' ) || ( ch == '.' ) || ( ch == 'e' ) || ( ch == 'E' ); ch = fSource.peek() )
+                number += static_cast< char >( fSource.get() );
+
+            bool aOK = false;
+            auto value = number.toDouble( &aOK );
+            if ( number.isEmpty() || !aOK )
+                return fail( QObject::tr( "illegal value" ) );
+            fHandler.value( value );
+            return true;
+        }
+
+        bool parseLiteral( const char *literal, const QJsonValue &value )
+        {
+            for ( auto ii = literal; *ii; ++ii )
+            {
+                if ( fSource.get() != *ii )
+                    return fail( QObject::tr( "illegal value" ) );
+            }
+            fHandler.value( value );
+            return true;
+        }
+
+        static const int kMaxDepth = 512;
+
+        NJSON::CByteSource &fSource;
+        IJsonHandler &fHandler;
+        int fDepth{ 0 };
+        QString fError;
+        qint64 fErrorOffset{ 0 };
+    };
+
+    // the fields of one movie entry, turned into a CMovie the same way for every format
+    struct SMovieFields
+    {
+        void clear() { *this = SMovieFields(); }
+
+        void set( const QString &key, const QJsonValue &value )
+        {
+            if ( key == "rank" )
+                fRank = value.toInt();
+            else if ( key == "name" )
+                fName = value.toString();
+            else if ( key == "year" )
+                fYear = value.toInt();
+            else if ( key == "width" )
+                fWidth = value.toInt();
+            else if ( key == "height" )
+                fHeight = value.toInt();
+            else if ( key == "type" )
+                fType = value.toString().toLower();
+            else if ( key == "collection" )
+                fCollection = value.toString();
+        }
+
+        NJSON::CMovie movie() const
+        {
+            std::pair< int, int > resolution{ -1, -1 };
+            if ( fWidth.has_value() && fHeight.has_value() )
+                resolution = { fWidth.value(), fHeight.value() };
+            else if ( fType.has_value() )
+            {
+                if ( fType.value() == "uhd" )
+                    resolution = { 3840, 2160 };
+                else if ( fType.value() == "dvd" )
+                    resolution = { 720, 480 };
+                else if ( fType.value().isEmpty() )
+                    resolution = { 1920, 1080 };
+            }
+            return NJSON::CMovie( fName, fYear, fRank.value_or( -1 ), resolution );
+        }
+
+        QString fName;
+        int fYear{ 0 };
+        std::optional< int > fRank;
+        std::optional< int > fWidth;
+        std::optional< int > fHeight;
+        std::optional< QString > fType;
+        std::optional< QString > fCollection;   // ndjson and csv only, json lists group movies by their collection object
+    };
+
+    // walks the list schema, only the movie being read is held
+    class CMovieListHandler : public IJsonHandler
+    {
+    public:
+        CMovieListHandler( NJSON::CMovieListReader *reader, bool isSequence, const NJSON::CMovieListReader::TMovieFunc &func ) :
+            fReader( reader ),
+            fIsSequence( isSequence ),
+            fFunc( func )
+        {
+        }
+
+        void startObject() override
+        {
+            auto top = fFrames.empty() ? std::optional< EFrame >() : fFrames.back().fType;
+            if ( !top.has_value() )
+            {
+                fFrames.push_back( { fIsSequence ? EFrame::eMovie : EFrame::eRoot, -1 } );
+                if ( fIsSequence )
+                    fMovie.clear();
+            }
+            else if ( top.value() == EFrame::eMovies )
+            {
+                fFrames.push_back( { EFrame::eMovie, fFrames.back().fCollection, fFrames.back().fDeferred } );
+                fMovie.clear();
+            }
+            else if ( top.value() == EFrame::eCollections )
+                fFrames.push_back( { EFrame::eCollection, fReader->addCollection( QString() ), true } );   // named once its "collection" key is read
+            else
+                fFrames.push_back( { EFrame::eSkip, -1 } );
+        }
+
+        void endObject() override
+        {
+            auto frame = fFrames.back();
+            fFrames.pop_back();
+            if ( frame.fType == EFrame::eMovie )
+            {
+                auto collection = frame.fCollection;
+                if ( fIsSequence )
+                    collection = fReader->collectionIndex( fMovie.fCollection.value_or( "<Unnamed Collection>" ) );
+                if ( frame.fDeferred )
+                    fDeferredMovies.emplace_back( collection, fMovie.movie() );
+                else
+                    fFunc( collection, fMovie.movie() );
+            }
+        }
+
+        // a top level movies list takes precedence over the collections, their movies are only handed out without one
+        void finish()
+        {
+            if ( !fHasMovies )
+            {
+                for ( auto &&ii : fDeferredMovies )
+                    fFunc( ii.first, ii.second );
+            }
+            fDeferredMovies.clear();
+        }
+
+        void startArray() override
+        {
+            auto top = fFrames.empty() ? std::optional< EFrame >() : fFrames.back().fType;
+            if ( !top.has_value() )
+                fTopLevelIsObject = false;
+
+            if ( top.has_value() && ( top.value() == EFrame::eRoot ) && ( fKey == "movies" ) )
+            {
+                if ( fHasCollections )
+                {
+                    // the collections read so far are replaced by the movies list
+                    fDeferredMovies.clear();
+                    fReader->clearCollections();
+                }
+                fHasList = true;
+                fHasMovies = true;
+                fFrames.push_back( { EFrame::eMovies, fReader->collectionIndex( "<Unnamed Collection>" ) } );
+            }
+            else if ( top.has_value() && ( top.value() == EFrame::eRoot ) && ( fKey == "collections" ) && !fHasMovies )
+            {
+                fHasList = true;
+                fHasCollections = true;
+                fFrames.push_back( { EFrame::eCollections, -1, true } );
+            }
+            else if ( top.has_value() && ( top.value() == EFrame::eCollection ) && ( fKey == "movies" ) )
+                fFrames.push_back( { EFrame::eMovies, fFrames.back().fCollection, true } );
+            else
+                fFrames.push_back( { EFrame::eSkip, -1 } );
+        }
+
+        void endArray() override { fFrames.pop_back(); }
+
+        void key( const QString &key ) override { fKey = key; }
+
+        void value( const QJsonValue &value ) override
+        {
+            if ( fFrames.empty() )
+            {
+                fTopLevelIsObject = false;
+                return;
+            }
+
+            auto &&top = fFrames.back();
+            if ( top.fType == EFrame::eMovie )
+                fMovie.set( fKey, value );
+            else if ( ( top.fType == EFrame::eCollection ) && ( fKey == "collection" ) )
+                fReader->setCollectionName( top.fCollection, value.toString() );
+            else if ( ( top.fType == EFrame::eRoot ) && ( ( fKey == "movies" ) || ( fKey == "collections" ) ) )
+                fListNotArray = true;
+        }
+
+        bool fTopLevelIsObject{ true };
+        bool fHasList{ false };
+        bool fListNotArray{ false };
+
+    private:
+        enum class EFrame
+        {
+            eRoot,
+            eMovies,
+            eMovie,
+            eCollections,
+            eCollection,
+            eSkip
+        };
+        struct SFrame
+        {
+            EFrame fType;
+            int fCollection;
+            bool fDeferred{ false };   // inside the collections, held until it is known there is no movies list
+        };
+
+        NJSON::CMovieListReader *fReader{ nullptr };
+        bool fIsSequence{ false };
+        const NJSON::CMovieListReader::TMovieFunc &fFunc;
+        std::vector< SFrame > fFrames;
+        QString fKey;
+        SMovieFields fMovie;
+        bool fHasMovies{ false };
+        bool fHasCollections{ false };
+        std::vector< std::pair< int, NJSON::CMovie > > fDeferredMovies;
+    };
+}
+
+namespace NJSON
+{
+    CMovieListReader::EFormat CMovieListReader::formatForFile( const QString &fileName )
+    {
+        auto suffix = QFileInfo( fileName ).suffix().toLower();
+        if ( suffix == "csv" )
+            return EFormat::eCSV;
+        if ( ( suffix == "ndjson" ) || ( suffix == "jsonl" ) )
+            return EFormat::eNDJSON;
+        return EFormat::eJSON;
+    }
+
+    QString CMovieListReader::fileDialogFilter()
+    {
+        return QObject::tr( "Movie List File (*.json *.ndjson *.jsonl *.csv);;All Files (* *.*)" );
+    }
+
+    CMovieListReader::CMovieListReader( const QString &fileName ) :
+        fFileName( fileName )
+    {
+    }
+
+    int CMovieListReader::addCollection( const QString &name )
+    {
+        fCollectionNames.push_back( name );
+        return static_cast< int >( fCollectionNames.size() - 1 );
+    }
+
+    int CMovieListReader::collectionIndex( const QString &name )
+    {
+        auto pos = std::find( fCollectionNames.begin(), fCollectionNames.end(), name );
+        if ( pos != fCollectionNames.end() )
+            return static_cast< int >( pos - fCollectionNames.begin() );
+        return addCollection( name );
+    }
+
+    void CMovieListReader::setCollectionName( int collection, const QString &name )
+    {
+        if ( ( collection >= 0 ) && ( collection < static_cast< int >( fCollectionNames.size() ) ) )
+            fCollectionNames[ collection ] = name;
+    }
+
+    void CMovieListReader::clearCollections()
+    {
+        fCollectionNames.clear();
+    }
+
+    bool CMovieListReader::read( const TMovieFunc &func, QString *msg )
+    {
+        fCollectionNames.clear();
+        if ( fFileName.isEmpty() )
+        {
+            if ( msg )
+                *msg = QString( "Filename is empty" );
+            return false;
+        }
+
+        QFile fi( fFileName );
+        if ( !fi.open( QFile::ReadOnly ) )
+        {
+            if ( msg )
+                *msg = QString( "Could not open file '%1', please chek permissions" ).arg( fFileName );
+            return false;
+        }
+
+        CByteSource source( &fi );
+        if ( source.peek() == 0xEF )   // utf-8 byte order mark
+        {
+            for ( int ii = 0; ii < 3; ++ii )
+                source.get();
+        }
+
+        switch ( formatForFile( fFileName ) )
+        {
+            case EFormat::eCSV:
+                return readCSV( source, func, msg );
+            case EFormat::eNDJSON:
+                return readJSON( source, true, func, msg );
+            case EFormat::eJSON:
+            default:
+                return readJSON( source, false, func, msg );
+        }
+    }
+
+    bool CMovieListReader::readJSON( CByteSource &source, bool isSequence, const TMovieFunc &func, QString *msg )
+    {
+        CMovieListHandler handler( this, isSequence, func );
+        CJsonTokenizer tokenizer( source, handler );
+        do
+        {
+            if ( !tokenizer.parseValue() )
+            {
+                if ( msg )
+                    *msg = tokenizer.errorString();
+                return false;
+            }
+
+            if ( !handler.fTopLevelIsObject )
+            {
+                if ( msg )
+                    *msg = isSequence ? QString( "Error: Each line should be a movie object" ) : QString( "Error: Top level item should be object" );
+                return false;
+            }
+        }
+        while ( isSequence && !tokenizer.atEnd() );
+
+        if ( !isSequence && !tokenizer.atEnd() )
+        {
+            if ( msg )
+                *msg = QString( "Error: Unexpected data after the top level object @ %1" ).arg( source.offset() );
+            return false;
+        }
+
+        if ( isSequence )
+            return true;
+
+        if ( handler.fListNotArray && !handler.fHasList )
+        {
+            if ( msg )
+                *msg = QString( "Error: Top level item 'collections' should be an array" );
+            return false;
+        }
+        if ( !handler.fHasList )
+        {
+            if ( msg )
+                *msg = QString( "Error: Top level item should contain an array called movies or collections" );
+            return false;
+        }
+        handler.finish();
+        return true;
+    }
+
+    namespace
+    {
+        // one row, quoted fields may hold commas, doubled quotes and line breaks, nullopt at the end of the file
+        std::optional< QStringList > readCSVRow( CByteSource &source )
+        {
+            if ( source.peek() == -1 )
+                return {};
+
+            QStringList retVal;
+            QByteArray field;
+            bool inQuotes = false;
+            while ( true )
+            {
+                auto ch = source.get();
+                if ( inQuotes )
+                {
+                    if ( ch == -1 )
+                        break;
+                    if ( ch != '"' )
+                        field += static_cast< char >( ch );
+                    else if ( source.peek() == '"' )
+                        field += static_cast< char >( source.get() );
+                    else
+                        inQuotes = false;
+                    continue;
+                }
+
+                if ( ( ch == -1 ) || ( ch == '\n' ) )
+                    break;
+                if ( ch == '\r' )
+                    continue;
+                if ( ch == '"' )
+                    inQuotes = true;
+                else if ( ch == ',' )
+                {
+                    retVal << QString::fromUtf8( field ).trimmed();
+                    field.clear();
+                }
+                else
+                    field += static_cast< char >( ch );
+            }
+            retVal << QString::fromUtf8( field ).trimmed();
+            return retVal;
+        }
+    }
+
+    bool CMovieListReader::readCSV( CByteSource &source, const TMovieFunc &func, QString *msg )
+    {
+        QStringList columns = { "name", "year" };   // the layout the missing movies export writes
+        bool firstRow = true;
+        SMovieFields fields;
+        for ( auto row = readCSVRow( source ); row.has_value(); row = readCSVRow( source ) )
+        {
+            auto &&values = row.value();
+            if ( ( values.count() == 1 ) && values.front().isEmpty() )
+                continue;
+
+            if ( firstRow )
+            {
+                firstRow = false;
+                if ( values.contains( "name", Qt::CaseInsensitive ) )
+                {
+                    columns.clear();
+                    for ( auto &&ii : values )
+                        columns << ii.toLower();
+                    continue;
+                }
+            }
+
+            fields.clear();
+            for ( int ii = 0; ( ii < values.count() ) && ( ii < columns.count() ); ++ii )
+            {
+                auto &&column = columns[ ii ];
+                if ( ( column == "name" ) || ( column == "type" ) || ( column == "collection" ) )
+                    fields.set( column, values[ ii ] );
+                else if ( !values[ ii ].isEmpty() )
+                    fields.set( column, values[ ii ].toInt() );
+            }
+            if ( fields.fName.isEmpty() )
+            {
+                if ( msg )
+                    *msg = QString( "Error: Row without a name @ %1" ).arg( source.offset() );
+                return false;
+            }
+            func( collectionIndex( fields.fCollection.value_or( "<Unnamed Collection>" ) ), fields.movie() );
+        }
+        return true;
+    }
+}
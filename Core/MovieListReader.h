@@ -0,0 +1,75 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MOVIELISTREADER_H
+#define __MOVIELISTREADER_H
+
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+namespace NJSON
+{
+    class CMovie;
+    class CByteSource;
+
+    // streams a movie list file, entries are handed out as they are read so the file is never held in memory as a whole
+    // json   - {"movies":[{...},...]} or {"collections":[{"collection":"name","movies":[{...},...]},...]}, when both are
+    //          present the movies list is used, so the collections movies are handed out once the whole file is read
+    // ndjson - one movie object per line, an optional "collection" key groups them
+    // csv    - name,year[,...] per row as written by the missing movies export, or a header row naming the
+    //          name, year, rank, width, height and type columns
+    class CMovieListReader
+    {
+    public:
+        enum class EFormat
+        {
+            eJSON,
+            eNDJSON,
+            eCSV
+        };
+        static EFormat formatForFile( const QString &fileName );   // by extension, .ndjson/.jsonl and .csv, anything else is json
+        static QString fileDialogFilter();
+
+        using TMovieFunc = std::function< void( int collection, const CMovie &movie ) >;
+
+        CMovieListReader( const QString &fileName );
+
+        bool read( const TMovieFunc &func, QString *msg = nullptr );   // false and msg set on error, the movies read up to it have been handed out
+
+        // collection name by the index passed to the movie function, a json collection may name itself after its movies
+        const std::vector< QString > &collectionNames() const { return fCollectionNames; }
+        int collectionIndex( const QString &name );   // adds the collection when it is new
+        int addCollection( const QString &name );   // always a new collection, json lists may repeat a name
+        void setCollectionName( int collection, const QString &name );
+        void clearCollections();
+
+    private:
+        bool readJSON( CByteSource &source, bool isSequence, const TMovieFunc &func, QString *msg );
+        bool readCSV( CByteSource &source, const TMovieFunc &func, QString *msg );
+
+        QString fFileName;
+        std::vector< QString > fCollectionNames;
+    };
+}
+#endif
@@ -75,7 +75,7 @@ void CMovieSearchFilterModel::addStubToSourceModel( const SMovieStub &movieStub
     auto mediaModel = dynamic_cast< CMediaModel * >( sourceModel() );
     if ( mediaModel )
     {
-        mediaModel->addMovieStub( movieStub, [ this, movieStub ]( std::shared_ptr< CMediaData > mediaData ) { return movieStub.equal( mediaData, true, true, false ); } );
+        mediaModel->addMovieStub( movieStub );
     }
 }
 
@@ -1,13 +1,10 @@
 #include "MovieStub.h"
 #include "MediaData.h"
+#include "TitleNormalizer.h"
 #include "SABUtils/HashUtils.h"
 #include <QJsonObject>
 #include <QJsonArray>
 
-#include <QRegularExpression>
-#include <unordered_map>
-#include "SABUtils/StringUtils.h"
-
 SMovieStub::SMovieStub( const QString &name ) :
     SMovieStub( name, 0 )
 {
@@ -41,37 +38,7 @@ SMovieStub::SMovieStub( std::shared_ptr< CMediaData > data )
 
 QString SMovieStub::nameKey( const QString &name )
 {
-    static std::unordered_map< QString, QString > sCache;
-    auto pos = sCache.find( name );
-    if ( pos != sCache.end() )
-        return ( *pos ).second;
-
-    auto retVal = name.toLower();
-    retVal = retVal.replace( QRegularExpression( "[^a-zA-Z0-9 ]" ), " " );
-    retVal = retVal.replace( QRegularExpression( R"(\b(chapter|part)\b)" ), " " );
-
-    auto startsWith = QStringList() << "the "
-                                    << "national lampoons "
-                                    << "monty pythons ";
-    for ( auto &&ii : startsWith )
-    {
-        if ( retVal.startsWith( ii ) )
-            retVal = retVal.mid( ii.length() );
-    }
-
-    auto words = retVal.split( " ", Qt::SkipEmptyParts );
-    for ( auto &&ii : words )
-    {
-        int value;
-        if ( NSABUtils::NStringUtils::isRomanNumeral( ii, &value ) )
-        {
-            ii = QString::number( value );
-        }
-    }
-    retVal = words.join( " " );
-
-    sCache[ name ] = retVal;
-    return retVal;
+    return CTitleNormalizer::key( name );
 }
 
 QJsonObject SMovieStub::toJSON() const
@@ -133,9 +100,8 @@ bool SMovieStub::equal( std::shared_ptr< CMediaData > mediaData, bool useName, b
     bool retVal = true;
     if ( useName )
     {
-        retVal = nameKey() == SMovieStub::nameKey( mediaData->name() );
-        if ( !retVal )
-            retVal = nameKey() == SMovieStub::nameKey( mediaData->originalTitle() );
+        auto key = nameKey();
+        retVal = ( key == mediaData->nameKey() ) || ( key == mediaData->originalTitleKey() );
     }
     if ( useYear )
         retVal = retVal && fYear == mediaData->premiereDate().year();
@@ -22,8 +22,19 @@
 
 #include "ProgressSystem.h"
 
+#include <algorithm>
+
+CProgressSystem::CProgressSystem() :
+    fOwnerThread( std::this_thread::get_id() ),
+    fLastPublished( std::chrono::steady_clock::now() )
+{
+}
+
+// a new title starts a new count, the ui resets its value along with it
 void CProgressSystem::setTitle( const QString &title )
 {
+    fValue = 0;
+    fPublishedValue = 0;
     if ( fSetTitleFunc )
         fSetTitleFunc( title );
 }
@@ -53,47 +64,84 @@ QString CProgressSystem::title() const
 
 void CProgressSystem::setMaximum( int count )
 {
+    fMaximum = count;
     if ( fSetMaximumFunc )
         fSetMaximumFunc( count );
 }
 
 int CProgressSystem::maximum() const
 {
-    if ( fMaximumFunc )
+    if ( fMaximumFunc && isOwnerThread() )
         return fMaximumFunc();
-    return 0;
+    return fMaximum;
 }
 
 int CProgressSystem::value() const
 {
-    if ( fValueFunc )
-        return fValueFunc();
-    return 0;
+    return fValue;
 }
 
 void CProgressSystem::setValue( int value ) const
 {
-    if ( fSetValueFunc )
-        fSetValueFunc( value );
+    fValue = value;
+    if ( isOwnerThread() )
+        publish( value );
 }
 
-void CProgressSystem::incProgress()
+void CProgressSystem::incProgress( int count )
 {
-    if ( fIncFunc )
-        fIncFunc();
+    auto value = fValue.fetch_add( count ) + count;
+    if ( isOwnerThread() )
+        publishIfDue( value );
+}
+
+void CProgressSystem::publishIfDue( int value ) const
+{
+    auto maximum = fMaximum.load();
+    auto step = std::max( 1, ( maximum / 100 ) * fPublishPercent );
+    auto now = std::chrono::steady_clock::now();
+    if ( ( value - fPublishedValue >= step ) || ( ( maximum > 0 ) && ( value >= maximum ) ) || ( ( now - fLastPublished ) >= fPublishInterval ) )
+    {
+        publish( value );
+        if ( fIncFunc )
+            fIncFunc();
+    }
+}
+
+void CProgressSystem::publish( int value ) const
+{
+    fPublishedValue = value;
+    fLastPublished = std::chrono::steady_clock::now();
+    if ( fSetValueFunc )
+        fSetValueFunc( value );
+    if ( fWasCanceledFunc && fWasCanceledFunc() )
+        fCanceled = true;
 }
 
 void CProgressSystem::resetProgress() const
 {
+    fValue = 0;
+    fPublishedValue = 0;
+    fCanceled = false;
     if ( fResetFunc )
         fResetFunc();
 }
 
+// only the atomic flag is read, the ui is asked when a value is published
 bool CProgressSystem::wasCanceled() const
 {
-    if ( fWasCanceledFunc )
-        return fWasCanceledFunc();
-    return false;
+    return fCanceled;
+}
+
+void CProgressSystem::cancel()
+{
+    fCanceled = true;
+}
+
+void CProgressSystem::setPublishRate( int msecs, int percent )
+{
+    fPublishInterval = std::chrono::milliseconds( msecs );
+    fPublishPercent = percent;
 }
 
 void CProgressSystem::setSetTitleFunc( std::function< void( const QString &title ) > setTitleFunc )
@@ -116,11 +164,6 @@ void CProgressSystem::setSetMaximumFunc( std::function< void( int ) > setMaximum
     fSetMaximumFunc = setMaximumFunc;
 }
 
-void CProgressSystem::setValueFunc( std::function< int() > valueFunc )
-{
-    fValueFunc = valueFunc;
-}
-
 void CProgressSystem::setSetValueFunc( std::function< void( int ) > setValueFunc )
 {
     fSetValueFunc = setValueFunc;
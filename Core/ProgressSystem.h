@@ -24,10 +24,21 @@
 #define __PROGRESSSYSTEM_H
 
 #include <QString>
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <list>
+#include <thread>
+#include <tuple>
+
+// the value is counted atomically, incProgress only publishes it through the set value and inc functions every
+// publish interval or publish percent of the maximum, and only on the thread that created the progress system
+// worker threads may call incProgress and wasCanceled, their counts are published by the next call on the creating thread
 class CProgressSystem
 {
 public:
+    CProgressSystem();
+
     void pushState();
     void popState();
 
@@ -40,9 +51,12 @@ public:
     int value() const;
     void setValue( int value ) const;
 
-    void incProgress();
+    void incProgress( int count = 1 );
     void resetProgress() const;
     bool wasCanceled() const;
+    void cancel();   // thread safe, wasCanceled is true until resetProgress
+
+    void setPublishRate( int msecs, int percent );   // defaults to every 100ms or every 1%
 
     void setSetTitleFunc( std::function< void( const QString &title ) > setTitleFunc );
     void setTitleFunc( std::function< QString() > titleFunc );
@@ -50,10 +64,9 @@ public:
     void setMaximumFunc( std::function< int() > maximumFunc );
     void setSetMaximumFunc( std::function< void( int ) > setMaximumFunc );
 
-    void setValueFunc( std::function< int() > valueFunc );
     void setSetValueFunc( std::function< void( int ) > setValueFunc );
 
-    void setIncFunc( std::function< void() > incFunc );
+    void setIncFunc( std::function< void() > incFunc );   // called after each published value, eg to process events
     void setResetFunc( std::function< void() > resetFunc );
     void setWasCanceledFunc( std::function< bool() > wasCanceledFunc );
 
@@ -64,7 +77,6 @@ private:
     std::function< int() > fMaximumFunc;
     std::function< void( int ) > fSetMaximumFunc;
 
-    std::function< int() > fValueFunc;
     std::function< void( int ) > fSetValueFunc;
 
     std::function< void() > fIncFunc;
@@ -72,6 +84,19 @@ private:
     std::function< bool() > fWasCanceledFunc;
 
 private:
+    bool isOwnerThread() const { return std::this_thread::get_id() == fOwnerThread; }
+    void publish( int value ) const;
+    void publishIfDue( int value ) const;
+
+    std::thread::id fOwnerThread;
+    mutable std::atomic< int > fValue{ 0 };
+    mutable std::atomic< int > fPublishedValue{ 0 };
+    mutable std::atomic< int > fMaximum{ 0 };
+    mutable std::atomic< bool > fCanceled{ false };
+    mutable std::chrono::steady_clock::time_point fLastPublished;   // owner thread only
+    std::chrono::milliseconds fPublishInterval{ 100 };
+    int fPublishPercent{ 1 };
+
     std::list< std::tuple< QString, int, int > > fStateStack;
 };
 
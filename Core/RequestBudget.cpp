@@ -0,0 +1,96 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RequestBudget.h"
+#include "Settings.h"
+
+#include <algorithm>
+
+CRequestBudget::CRequestBudget( std::shared_ptr< CSettings > settings, QObject *parent ) :
+    QObject( parent ),
+    fSettings( settings )
+{
+}
+
+bool CRequestBudget::hasFreeSlot( const QString &hostName ) const
+{
+    auto maxInFlight = fSettings->maxRequestsPerServer();
+    return ( maxInFlight <= 0 ) || ( inFlight( hostName ) < maxInFlight );
+}
+
+bool CRequestBudget::tryAcquire( const QString &hostName, const QObject *client )
+{
+    auto &&waiting = fWaiting[ hostName ];
+    if ( !hasFreeSlot( hostName ) || ( !waiting.empty() && ( waiting.front() != client ) ) )
+    {
+        if ( std::find( waiting.begin(), waiting.end(), client ) == waiting.end() )
+            waiting.push_back( client );
+        return false;
+    }
+
+    if ( !waiting.empty() )
+        waiting.pop_front();
+    fInFlight[ hostName ]++;
+    return true;
+}
+
+void CRequestBudget::release( const QString &hostName )
+{
+    auto pos = fInFlight.find( hostName );
+    if ( ( pos == fInFlight.end() ) || ( ( *pos ).second <= 0 ) )
+        return;
+    ( *pos ).second--;
+    offerFreeSlots( hostName );
+}
+
+void CRequestBudget::removeClient( const QObject *client )
+{
+    for ( auto &&ii : fWaiting )
+    {
+        auto wasFront = !ii.second.empty() && ( ii.second.front() == client );
+        ii.second.remove( client );
+        if ( wasFront )
+            offerFreeSlots( ii.first );
+    }
+}
+
+// the clients are connected directly, so each has tried to take the slot once the signal returns
+// a client at the front that did not take it has nothing left for the host and loses its turn
+void CRequestBudget::offerFreeSlots( const QString &hostName )
+{
+    auto &&waiting = fWaiting[ hostName ];
+    while ( hasFreeSlot( hostName ) && !waiting.empty() )
+    {
+        auto front = waiting.front();
+        emit sigSlotReleased();
+        if ( hasFreeSlot( hostName ) && !waiting.empty() && ( waiting.front() == front ) )
+            waiting.pop_front();
+    }
+}
+
+int CRequestBudget::inFlight( const QString &hostName ) const
+{
+    auto pos = fInFlight.find( hostName );
+    if ( pos == fInFlight.end() )
+        return 0;
+    return ( *pos ).second;
+}
@@ -0,0 +1,61 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __REQUESTBUDGET_H
+#define __REQUESTBUDGET_H
+
+#include <QObject>
+#include <QString>
+
+#include <list>
+#include <map>
+#include <memory>
+
+class CSettings;
+
+// in flight request slots per host, shared by every sync system talking to the same servers
+// so running several user syncs at once stays within MaxRequestsPerServer for each server
+// a client refused a slot waits its turn, freed slots go to the waiting clients round robin
+class CRequestBudget : public QObject
+{
+    Q_OBJECT
+public:
+    CRequestBudget( std::shared_ptr< CSettings > settings, QObject *parent = nullptr );
+
+    bool tryAcquire( const QString &hostName, const QObject *client );   // false when the host has no free slot or it is another clients turn
+    void release( const QString &hostName );   // offers the slot to the waiting clients through sigSlotReleased
+    void removeClient( const QObject *client );   // the client has nothing left to send
+
+    int inFlight( const QString &hostName ) const;
+
+Q_SIGNALS:
+    void sigSlotReleased();
+
+private:
+    bool hasFreeSlot( const QString &hostName ) const;
+    void offerFreeSlots( const QString &hostName );
+
+    std::shared_ptr< CSettings > fSettings;
+    std::map< QString, int > fInFlight;   // host -> requests sent and not yet finished
+    std::map< QString, std::list< const QObject * > > fWaiting;   // host -> clients refused a slot, in turn order
+};
+#endif
@@ -0,0 +1,136 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SeriesIndex.h"
+#include "MediaData.h"
+
+std::optional< CSeriesIndex::TEntry > CSeriesIndex::entryFor( const std::shared_ptr< CMediaData > &media )
+{
+    if ( !media || ( media->mediaType() != "Episode" ) )
+        return {};
+
+    auto name = media->seriesName();
+    if ( name.isEmpty() )
+        return {};
+    return TEntry( name, media->season() );
+}
+
+void CSeriesIndex::add( const std::shared_ptr< CMediaData > &media )
+{
+    if ( fEntries.find( media ) != fEntries.end() )
+        return;
+
+    auto entry = entryFor( media );
+    if ( !entry.has_value() )
+        return;
+
+    fEntries[ media ] = entry.value();
+    addEntry( entry.value() );
+}
+
+void CSeriesIndex::remove( const std::shared_ptr< CMediaData > &media )
+{
+    auto pos = fEntries.find( media );
+    if ( pos == fEntries.end() )
+        return;
+
+    removeEntry( ( *pos ).second );
+    fEntries.erase( pos );
+}
+
+void CSeriesIndex::update( const std::shared_ptr< CMediaData > &media )
+{
+    auto entry = entryFor( media );
+    auto pos = fEntries.find( media );
+    if ( pos == fEntries.end() )
+    {
+        if ( entry.has_value() )
+            add( media );
+        return;
+    }
+
+    if ( entry.has_value() && ( entry.value() == ( *pos ).second ) )
+        return;
+
+    remove( media );
+    if ( entry.has_value() )
+        add( media );
+}
+
+void CSeriesIndex::clear()
+{
+    if ( fEntries.empty() )
+        return;
+
+    fSeries.clear();
+    fEntries.clear();
+    fGeneration++;
+}
+
+void CSeriesIndex::addEntry( const TEntry &entry )
+{
+    fSeries[ entry.first ][ entry.second ]++;
+    fGeneration++;
+}
+
+void CSeriesIndex::removeEntry( const TEntry &entry )
+{
+    auto pos = fSeries.find( entry.first );
+    if ( pos == fSeries.end() )
+        return;
+
+    auto &&seasons = ( *pos ).second;
+    auto pos2 = seasons.find( entry.second );
+    if ( ( pos2 != seasons.end() ) && ( --( *pos2 ).second <= 0 ) )
+        seasons.erase( pos2 );
+    if ( seasons.empty() )
+        fSeries.erase( pos );
+    fGeneration++;
+}
+
+std::set< QString > CSeriesIndex::names() const
+{
+    std::set< QString > retVal;
+    for ( auto &&ii : fSeries )
+        retVal.insert( retVal.end(), ii.first );
+    return retVal;
+}
+
+std::optional< SSeriesSummary > CSeriesIndex::summary( const QString &seriesName ) const
+{
+    auto pos = fSeries.find( seriesName );
+    if ( pos == fSeries.end() )
+        return {};
+
+    SSeriesSummary retVal;
+    for ( auto &&ii : ( *pos ).second )
+    {
+        retVal.fEpisodeCount += ii.second;
+        if ( !ii.first.has_value() )
+            continue;
+        // the seasons are ordered with the unknown season first
+        if ( !retVal.fMinSeason.has_value() )
+            retVal.fMinSeason = ii.first;
+        retVal.fMaxSeason = ii.first;
+    }
+    return retVal;
+}
@@ -0,0 +1,72 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SERIESINDEX_H
+#define __SERIESINDEX_H
+
+#include <QString>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <unordered_map>
+
+class CMediaData;
+
+struct SSeriesSummary
+{
+    int fEpisodeCount{ 0 };
+    std::optional< int > fMinSeason;
+    std::optional< int > fMaxSeason;
+};
+
+// series name -> the number of its episodes per season, kept in step with the rows of the media model
+// only episodes with a series name are counted, a reload that changes the series or season of an episode moves its count
+class CSeriesIndex
+{
+public:
+    void add( const std::shared_ptr< CMediaData > &media );
+    void remove( const std::shared_ptr< CMediaData > &media );   // removes the counts the media was added with, even if it changed since
+    void update( const std::shared_ptr< CMediaData > &media );
+    void clear();
+
+    std::set< QString > names() const;
+    std::optional< SSeriesSummary > summary( const QString &seriesName ) const;
+    size_t size() const { return fSeries.size(); }
+
+    // bumped whenever a series is added or removed or its summary changes, a view only has to refresh when it moved
+    uint64_t generation() const { return fGeneration; }
+
+private:
+    using TEntry = std::pair< QString, std::optional< int > >;   // series name, season
+    static std::optional< TEntry > entryFor( const std::shared_ptr< CMediaData > &media );
+
+    void addEntry( const TEntry &entry );
+    void removeEntry( const TEntry &entry );
+
+    std::map< QString, std::map< std::optional< int >, int > > fSeries;   // series name -> season -> episode count
+    std::unordered_map< std::shared_ptr< CMediaData >, TEntry > fEntries;   // media -> what it was counted under
+    uint64_t fGeneration{ 0 };
+};
+#endif
@@ -375,6 +375,17 @@ int CServerModel::serverCnt() const
     return static_cast< int >( fServers.size() );
 }
 
+QStringList CServerModel::enabledServerNames() const
+{
+    QStringList retVal;
+    for ( auto &&ii : fServers )
+    {
+        if ( ii->isEnabled() )
+            retVal << ii->keyName();
+    }
+    return retVal;
+}
+
 void CServerModel::setAPIKey( const QString &serverName, const QString &apiKey )
 {
     auto serverInfo = this->findServerInfoInternal( serverName );
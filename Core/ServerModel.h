@@ -54,6 +54,7 @@ public:
 
     int enabledServerCnt() const;
     int serverCnt() const;
+    QStringList enabledServerNames() const;
 
     bool canAllServersSync() const;
     bool canAnyServerSync() const;
@@ -22,6 +22,7 @@
 
 #include "Settings.h"
 #include "ServerModel.h"
+#include "SyncSystem.h"
 #include "Core/ServerInfo.h"
 
 #include <QJsonDocument>
@@ -36,6 +37,7 @@
 #include <QColor>
 
 #include <map>
+#include <algorithm>
 
 CSettings::CSettings( std::shared_ptr< CServerModel > serverModel ) :
     CSettings( true, serverModel )
@@ -80,6 +82,42 @@ void CSettings::setLoadLastProject( bool value )
     settings.setValue( "LoadLastProject", value );
 }
 
+int CSettings::logMaxLines()
+{
+    QSettings settings;
+    return settings.value( "LogMaxLines", 10000 ).toInt();
+}
+
+void CSettings::setLogMaxLines( int value )
+{
+    QSettings settings;
+    settings.setValue( "LogMaxLines", value );
+}
+
+int CSettings::logLevel()
+{
+    QSettings settings;
+    return settings.value( "LogLevel", EMsgType::eInfo ).toInt();
+}
+
+void CSettings::setLogLevel( int value )
+{
+    QSettings settings;
+    settings.setValue( "LogLevel", value );
+}
+
+QString CSettings::logFileName()
+{
+    QSettings settings;
+    return settings.value( "LogFileName", QString() ).toString();
+}
+
+void CSettings::setLogFileName( const QString &value )
+{
+    QSettings settings;
+    settings.setValue( "LogFileName", value );
+}
+
 QVariant CSettings::getValue( const QJsonObject &json, const QString &fieldName, const QVariant &defaultValue ) const
 {
     if ( json.find( fieldName ) == json.end() )
@@ -161,6 +199,11 @@ bool CSettings::load( const QString &fileName, std::function< void( const QStrin
     setMediaSourceColor( getValue( json.object(), "MediaSourceColor", "yellow" ).toString() );
     setMediaDestColor( getValue( json.object(), "MediaDestColor", "yellow" ).toString() );
     setMaxItems( getValue( json.object(), "MaxItems", -1 ).toInt() );
+    setMediaPageSize( getValue( json.object(), "MediaPageSize", 1000 ).toInt() );
+    setMediaPagesInFlight( getValue( json.object(), "MediaPagesInFlight", 3 ).toInt() );
+    setMaxRequestsPerServer( getValue( json.object(), "MaxRequestsPerServer", 4 ).toInt() );
+    setCacheMedia( getValue( json.object(), "CacheMedia", true ).toBool() );
+    setMediaCacheMaxAgeDays( getValue( json.object(), "MediaCacheMaxAgeDays", 7 ).toInt() );
     setSyncAudio( getValue( json.object(), "SyncAudio", true ).toBool() );
     setSyncVideo( getValue( json.object(), "SyncVideo", true ).toBool() );
     setSyncEpisode( getValue( json.object(), "SyncEpisode", true ).toBool() );
@@ -256,6 +299,11 @@ bool CSettings::save( std::function< void( const QString &title, const QString &
     root[ "MediaSourceColor" ] = mediaSourceColor().name();
     root[ "MediaDestColor" ] = mediaDestColor().name();
     root[ "MaxItems" ] = maxItems();
+    root[ "MediaPageSize" ] = mediaPageSize();
+    root[ "MediaPagesInFlight" ] = mediaPagesInFlight();
+    root[ "MaxRequestsPerServer" ] = maxRequestsPerServer();
+    root[ "CacheMedia" ] = cacheMedia();
+    root[ "MediaCacheMaxAgeDays" ] = mediaCacheMaxAgeDays();
 
     root[ "SyncAudio" ] = syncAudio();
     root[ "SyncVideo" ] = syncVideo();
@@ -386,6 +434,31 @@ void CSettings::setMaxItems( int maxItems )
     updateValue( fMaxItems, maxItems );
 }
 
+void CSettings::setMediaPageSize( int pageSize )
+{
+    updateValue( fMediaPageSize, pageSize );
+}
+
+void CSettings::setMediaPagesInFlight( int numPages )
+{
+    updateValue( fMediaPagesInFlight, std::max( 1, numPages ) );
+}
+
+void CSettings::setMaxRequestsPerServer( int maxRequests )
+{
+    updateValue( fMaxRequestsPerServer, maxRequests );
+}
+
+void CSettings::setCacheMedia( bool value )
+{
+    updateValue( fCacheMedia, value );
+}
+
+void CSettings::setMediaCacheMaxAgeDays( int days )
+{
+    updateValue( fMediaCacheMaxAgeDays, days );
+}
+
 void CSettings::setSyncAudio( bool value )
 {
     updateValue( fSyncAudio, value );
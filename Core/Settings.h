@@ -62,6 +62,15 @@ public:
     static bool loadLastProject();
     static void setLoadLastProject( bool value );
 
+    static int logMaxLines();
+    static void setLogMaxLines( int value );
+
+    static int logLevel();   // an EMsgType, the least severe message shown in the log
+    static void setLogLevel( int value );
+
+    static QString logFileName();   // empty when the log is not written to a file
+    static void setLogFileName( const QString &value );
+
     // settings stored in the json settings file
     QString fileName() const { return fFileName; }
 
@@ -93,6 +102,21 @@ public:
     int maxItems() const { return fMaxItems; }
     void setMaxItems( int maxItems );
 
+    int mediaPageSize() const { return fMediaPageSize; }   // 0 or less means load all the media in one request
+    void setMediaPageSize( int pageSize );
+
+    int mediaPagesInFlight() const { return fMediaPagesInFlight; }   // per server
+    void setMediaPagesInFlight( int numPages );
+
+    int maxRequestsPerServer() const { return fMaxRequestsPerServer; }   // 0 or less means unlimited
+    void setMaxRequestsPerServer( int maxRequests );
+
+    bool cacheMedia() const { return fCacheMedia; }
+    void setCacheMedia( bool value );
+
+    int mediaCacheMaxAgeDays() const { return fMediaCacheMaxAgeDays; }   // 0 or less means never force a full reload
+    void setMediaCacheMaxAgeDays( int days );
+
     bool syncAudio() const { return fSyncAudio; }
     void setSyncAudio( bool value );
 
@@ -179,6 +203,11 @@ private:
     QColor fMediaDestColor{ "yellow" };
     QColor fMediaDataMissingColor{ "red" };
     int fMaxItems{ -1 };
+    int fMediaPageSize{ 1000 };
+    int fMediaPagesInFlight{ 3 };
+    int fMaxRequestsPerServer{ 4 };
+    bool fCacheMedia{ true };
+    int fMediaCacheMaxAgeDays{ 7 };
 
     bool fOnlyShowSyncableUsers{ true };
 
@@ -0,0 +1,98 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "StringPool.h"
+
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QReadWriteLock>
+
+#include <vector>
+
+namespace
+{
+    QMutex sPoolMutex;
+    QSet< QString > sPool;
+
+    QReadWriteLock sServerLock;
+    QHash< QString, int > sServerIndexes;
+    std::vector< QString > sServerNames;
+}
+
+QString CStringPool::intern( const QString &value )
+{
+    if ( value.isEmpty() )
+        return value;
+
+    QMutexLocker locker( &sPoolMutex );
+    auto pos = sPool.find( value );
+    if ( pos == sPool.end() )
+        pos = sPool.insert( value );
+    return *pos;
+}
+
+int CStringPool::size()
+{
+    QMutexLocker locker( &sPoolMutex );
+    return sPool.size();
+}
+
+int CServerIndex::index( const QString &serverName )
+{
+    auto retVal = find( serverName );
+    if ( retVal != -1 )
+        return retVal;
+
+    QWriteLocker locker( &sServerLock );
+    auto pos = sServerIndexes.find( serverName );   // another thread may have registered it
+    if ( pos != sServerIndexes.end() )
+        return pos.value();
+
+    retVal = static_cast< int >( sServerNames.size() );
+    sServerNames.push_back( serverName );
+    sServerIndexes[ serverName ] = retVal;
+    return retVal;
+}
+
+int CServerIndex::find( const QString &serverName )
+{
+    QReadLocker locker( &sServerLock );
+    auto pos = sServerIndexes.constFind( serverName );
+    if ( pos == sServerIndexes.constEnd() )
+        return -1;
+    return pos.value();
+}
+
+QString CServerIndex::name( int index )
+{
+    QReadLocker locker( &sServerLock );
+    if ( ( index < 0 ) || ( index >= static_cast< int >( sServerNames.size() ) ) )
+        return {};
+    return sServerNames[ index ];
+}
+
+int CServerIndex::count()
+{
+    QReadLocker locker( &sServerLock );
+    return static_cast< int >( sServerNames.size() );
+}
@@ -0,0 +1,48 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __STRINGPOOL_H
+#define __STRINGPOOL_H
+
+#include <QString>
+
+// process wide pool for short strings that repeat across most media (types, provider names, external url hosts)
+// the returned copy shares its data with every other interned copy, so each distinct value is stored once
+// never intern high cardinality values such as IDs, the pool is never emptied
+class CStringPool
+{
+public:
+    static QString intern( const QString &value );   // thread safe
+    static int size();
+};
+
+// process wide dense index for server key names, lets per server data live in a flat array
+// indexes are never reused, a server that is removed keeps its slot
+class CServerIndex
+{
+public:
+    static int index( const QString &serverName );   // registers the server when needed, thread safe
+    static int find( const QString &serverName );   // -1 if the server was never registered
+    static QString name( int index );
+    static int count();
+};
+#endif
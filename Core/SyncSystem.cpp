@@ -29,6 +29,11 @@
 #include "MediaModel.h"
 #include "ServerModel.h"
 #include "CollectionsModel.h"
+#include "AvatarCache.h"
+#include "MediaCache.h"
+#include "RequestBudget.h"
+#include "LibraryStructure.h"
+#include "Logging.h"
 
 #include "ServerInfo.h"
 #include "MediaData.h"
@@ -36,6 +41,7 @@
 #include "SABUtils/StringUtils.h"
 
 #include <unordered_set>
+#include <algorithm>
 
 #include <QTimer>
 #include <QDebug>
@@ -52,6 +58,7 @@
 #include <QJsonObject>
 #include <QBuffer>
 #include <QUrlQuery>
+#include <QThreadPool>
 
 QString toString( ERequestType request )
 {
@@ -75,6 +82,14 @@ QString toString( ERequestType request )
             return "SetUserAvatar";
         case ERequestType::eGetMediaList:
             return "GetMediaList";
+        case ERequestType::eGetMediaListPage:
+            return "GetMediaListPage";
+        case ERequestType::eGetMediaListDelta:
+            return "GetMediaListDelta";
+        case ERequestType::eGetMediaUserData:
+            return "GetMediaUserData";
+        case ERequestType::eGetMediaUserDataPage:
+            return "GetMediaUserDataPage";
         case ERequestType::eReloadMediaData:
             return "ReloadMediaData";
         case ERequestType::eUpdateUserMediaData:
@@ -103,6 +118,8 @@ QString toString( ERequestType request )
             return "GetCollection";
         case ERequestType::eCreateCollection:
             return "CreateCollection";
+        case ERequestType::eVerifyUserMediaData:
+            return "VerifyUserMediaData";
     }
     return {};
 }
@@ -137,9 +154,30 @@ CSyncSystem::CSyncSystem( std::shared_ptr< CSettings > settings, std::shared_ptr
     fMediaModel( mediaModel ),
     fCollectionsModel( collectionsModel ),
     fServerModel( serverModel ),
-    fProgressSystem( new CProgressSystem )
+    fProgressSystem( new CProgressSystem ),
+    fMediaCache( new CMediaCache ),
+    fDecodePool( std::make_unique< QThreadPool >() )
 {
-    fManager = new QNetworkAccessManager( this );
+    setNetworkAccessManager( new QNetworkAccessManager( this ) );
+    setRequestBudget( std::make_shared< CRequestBudget >( settings ) );
+
+    fAvatarCache = new CAvatarCache( QString(), this );
+    connect(
+        fAvatarCache, &CAvatarCache::sigAvatarLoaded, this,
+        [ this ]( const QString &serverName, const QString &userID, const QImage &image, const QByteArray &hash ) { fUsersModel->setUserAvatar( serverName, userID, image, hash ); } );
+    connect( fAvatarCache, &CAvatarCache::sigAvatarMissing, this, [ this ]( const QString &serverName, const QString &userID ) { requestGetUserAvatar( serverName, userID ); } );
+    connect( fUsersModel.get(), &CUsersModel::sigCleared, fAvatarCache, &CAvatarCache::clear );   // the decoded images are only needed while their users are loaded
+}
+
+// only replace the manager while no requests are outstanding, the sync system takes ownership
+void CSyncSystem::setNetworkAccessManager( QNetworkAccessManager *manager )
+{
+    if ( !manager || ( manager == fManager ) )
+        return;
+
+    delete fManager;
+    fManager = manager;
+    fManager->setParent( this );
 #if QT_VERSION > QT_VERSION_CHECK( 5, 14, 0 )
     fManager->setAutoDeleteReplies( true );
 #endif
@@ -152,6 +190,44 @@ CSyncSystem::CSyncSystem( std::shared_ptr< CSettings > settings, std::shared_ptr
     connect( fManager, &QNetworkAccessManager::finished, this, &CSyncSystem::slotRequestFinished );
 }
 
+CSyncSystem::~CSyncSystem()
+{
+    fDecodePool->waitForDone();   // a finished decode only posts its items to this object
+
+    // the budget may be shared with sync systems that keep running
+    if ( fRequestBudget )
+    {
+        disconnect( fRequestBudget.get(), nullptr, this, nullptr );
+        fRequestBudget->removeClient( this );
+    }
+}
+
+void CSyncSystem::setRequestBudget( std::shared_ptr< CRequestBudget > budget )
+{
+    if ( !budget || ( budget == fRequestBudget ) )
+        return;
+
+    if ( fRequestBudget )
+    {
+        disconnect( fRequestBudget.get(), nullptr, this, nullptr );
+        fRequestBudget->removeClient( this );
+    }
+    fRequestBudget = budget;
+    connect( fRequestBudget.get(), &CRequestBudget::sigSlotReleased, this, [ this ]() { dispatchPendingRequests(); } );
+}
+
+void CSyncSystem::setLibraryStructure( std::shared_ptr< CLibraryStructure > libraryStructure )
+{
+    if ( libraryStructure == fLibraryStructure )
+        return;
+
+    if ( fLibraryStructure )
+        disconnect( fLibraryStructure.get(), nullptr, this, nullptr );
+    fLibraryStructure = libraryStructure;
+    if ( fLibraryStructure )
+        connect( fLibraryStructure.get(), &CLibraryStructure::sigLoadFinished, this, &CSyncSystem::slotLibraryStructureLoaded );
+}
+
 void CSyncSystem::setProcessNewMediaFunc( std::function< void( std::shared_ptr< CMediaData > userData ) > processNewMediaFunc )
 {
     fProcessNewMediaFunc = processNewMediaFunc;
@@ -503,19 +579,35 @@ void CSyncSystem::requestUpdateUserDataForMedia( const QString &serverName, std:
     // qDebug() << url;
 
     auto request = QNetworkRequest( url );
-    auto reply = makeRequest( request, ENetworkRequestType::ePost, data );
-
-    setServerName( reply, serverName );
-    setExtraData( reply, mediaID );
-    setRequestType( reply, ERequestType::eUpdateUserMediaData );
+    setServerName( request, serverName );
+    setExtraData( request, mediaID );
+    setRequestType( request, ERequestType::eUpdateUserMediaData );
+    addWriteBack( serverName, mediaID, mediaData, newData );
+    makeRequest( request, ENetworkRequestType::ePost, data );
 }
 
 void CSyncSystem::handleUpdateUserDataForMedia( const QString &serverName, const QString &mediaID )
 {
-    requestReloadMediaItemData( serverName, mediaID );
-    auto mediaData = fMediaModel->getMediaDataForID( serverName, mediaID );
+    auto writeBack = findWriteBack( serverName, mediaID );
+    auto mediaData = writeBack ? writeBack->fMediaData : std::shared_ptr< CMediaData >();
+    if ( mediaData )
+    {
+        auto newData = writeBack->fNewData;
+        auto currData = mediaData->userMediaData( serverName );
+        if ( newData && currData )
+        {
+            // the server accepted the write, so update the local copy rather than re-reading the item
+            currData->fPlayed = newData->fPlayed;
+            currData->fLastPlayedDate = newData->fLastPlayedDate;
+            currData->fPlayCount = newData->fPlayCount;
+            currData->fPlaybackPositionTicks = newData->fPlaybackPositionTicks;
+            fMediaModel->updateMediaData( mediaData );
+        }
+        ( *fWriteBacks.find( serverName ) ).second.fToVerify.insert( mediaID );   // findWriteBack found it
+    }
     if ( mediaData )
         emit sigAddToLog( EMsgType::eInfo, tr( "Updated '%1(%2)' on Server '%3' successfully" ).arg( mediaData->name() ).arg( mediaID ).arg( serverName ) );
+    finishWriteBack( serverName );
 }
 
 void CSyncSystem::requestSetFavorite( const QString &serverName, std::shared_ptr< CMediaData > mediaData, std::shared_ptr< SMediaServerData > newData )
@@ -539,21 +631,164 @@ void CSyncSystem::requestSetFavorite( const QString &serverName, std::shared_ptr
 
     auto request = QNetworkRequest( url );
 
-    QNetworkReply *reply = nullptr;
+    setServerName( request, serverName );
+    setExtraData( request, mediaID );
+    setRequestType( request, ERequestType::eUpdateFavorite );
+    addWriteBack( serverName, mediaID, mediaData, newData );
     if ( newData->fIsFavorite )
-        reply = makeRequest( request, ENetworkRequestType::ePost );
+        makeRequest( request, ENetworkRequestType::ePost );
     else
-        reply = makeRequest( request, ENetworkRequestType::eDeleteResource );
-
-    setServerName( reply, serverName );
-    setExtraData( reply, mediaID );
-    setRequestType( reply, ERequestType::eUpdateFavorite );
+        makeRequest( request, ENetworkRequestType::eDeleteResource );
 }
 
 void CSyncSystem::handleSetFavorite( const QString &serverName, const QString &mediaID )
 {
-    requestReloadMediaItemData( serverName, mediaID );
+    auto writeBack = findWriteBack( serverName, mediaID );
+    auto mediaData = writeBack ? writeBack->fMediaData : std::shared_ptr< CMediaData >();
+    if ( mediaData )
+    {
+        auto newData = writeBack->fNewData;
+        auto currData = mediaData->userMediaData( serverName );
+        if ( newData && currData )
+        {
+            currData->fIsFavorite = newData->fIsFavorite;
+            fMediaModel->updateMediaData( mediaData );
+        }
+        ( *fWriteBacks.find( serverName ) ).second.fToVerify.insert( mediaID );   // findWriteBack found it
+    }
     emit sigAddToLog( EMsgType::eInfo, tr( "Updated Favorite status for '%1' on Server '%2' successfully" ).arg( mediaID ).arg( serverName ) );
+    finishWriteBack( serverName );
+}
+
+void CSyncSystem::addWriteBack( const QString &serverName, const QString &mediaID, std::shared_ptr< CMediaData > mediaData, std::shared_ptr< SMediaServerData > newData )
+{
+    auto &&writeBack = fWriteBacks[ serverName ];
+    writeBack.fItems[ mediaID ] = { mediaData, newData };
+    writeBack.fOutstandingWrites++;
+}
+
+const SWriteBackItem *CSyncSystem::findWriteBack( const QString &serverName, const QString &mediaID ) const
+{
+    auto pos = fWriteBacks.find( serverName );
+    if ( pos == fWriteBacks.end() )
+        return nullptr;
+
+    auto pos2 = ( *pos ).second.fItems.find( mediaID );
+    if ( pos2 == ( *pos ).second.fItems.end() )
+        return nullptr;
+    return &( *pos2 ).second;
+}
+
+// called once per finished write (successful or not), when the last one for the server finishes the written items are re-read in bulk
+void CSyncSystem::finishWriteBack( const QString &serverName )
+{
+    auto pos = fWriteBacks.find( serverName );
+    if ( pos == fWriteBacks.end() )
+        return;
+
+    auto &&writeBack = ( *pos ).second;
+    if ( writeBack.fOutstandingWrites > 0 )
+        writeBack.fOutstandingWrites--;
+    if ( writeBack.fOutstandingWrites > 0 )
+        return;
+
+    if ( writeBack.fToVerify.empty() )
+    {
+        fWriteBacks.erase( pos );
+        return;
+    }
+
+    emit sigAddToLog( EMsgType::eInfo, tr( "Verifying %1 updated items on server '%2'" ).arg( writeBack.fToVerify.size() ).arg( serverName ) );
+
+    // keep the URLs to a reasonable length
+    const int kMaxIDsPerRequest = 100;
+    QStringList mediaIDs;
+    for ( auto &&ii : writeBack.fToVerify )
+    {
+        mediaIDs << ii;
+        if ( mediaIDs.size() == kMaxIDsPerRequest )
+        {
+            requestVerifyUserMediaData( serverName, mediaIDs );
+            mediaIDs.clear();
+        }
+    }
+    if ( !mediaIDs.isEmpty() )
+        requestVerifyUserMediaData( serverName, mediaIDs );
+    writeBack.fToVerify.clear();
+
+    if ( writeBack.fOutstandingVerifies == 0 )
+        fWriteBacks.erase( serverName );
+}
+
+void CSyncSystem::requestVerifyUserMediaData( const QString &serverName, const QStringList &mediaIDs )
+{
+    if ( !currUser().second )
+        return;
+
+    // ItemsService
+    auto &&url = fServerModel->findServerInfo( serverName )->getUrl( QString( "Users/%1/Items" ).arg( currUser().second->getUserID( serverName ) ), { { "Ids", mediaIDs.join( "," ) } } );
+    if ( !url.isValid() )
+        return;
+
+    // qDebug() << url;
+    auto request = QNetworkRequest( url );
+
+    fWriteBacks[ serverName ].fOutstandingVerifies++;
+
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eVerifyUserMediaData );
+    makeRequest( request );
+}
+
+void CSyncSystem::handleVerifyUserMediaDataResponse( const QString &serverName, const QByteArray &data )
+{
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson( data, &error );
+    if ( error.error != QJsonParseError::NoError )
+    {
+        if ( fUserMsgFunc )
+            fUserMsgFunc( EMsgType::eError, tr( "Invalid Response" ), tr( "Invalid Response from Server: %1 - %2" ).arg( error.errorString() ).arg( QString( data ) ).arg( error.offset ) );
+    }
+    else
+    {
+        auto items = toItemArray( doc );
+        for ( auto &&ii : items )
+        {
+            auto media = ii.toObject();
+            auto mediaID = media[ "Id" ].toString();
+            // a reply arriving after the write back was canceled is dropped
+            auto writeBack = findWriteBack( serverName, mediaID );
+            if ( !writeBack )
+                continue;
+
+            auto mediaData = writeBack->fMediaData;
+            if ( !mediaData || !mediaData->userMediaData( serverName ) || !media.contains( "UserData" ) )
+                continue;
+
+            auto currData = mediaData->userMediaData( serverName );
+            currData->loadUserDataFromJSON( media[ "UserData" ].toObject() );
+            fMediaModel->updateMediaData( mediaData );
+
+            auto newData = writeBack->fNewData;
+            if ( newData && !currData->userDataEqual( *newData ) )
+                emit sigAddToLog( EMsgType::eWarning, tr( "Update of '%1(%2)' on Server '%3' did not take effect" ).arg( mediaData->name() ).arg( mediaID ).arg( serverName ) );
+        }
+    }
+    finishVerifyUserMediaData( serverName );
+}
+
+void CSyncSystem::finishVerifyUserMediaData( const QString &serverName )
+{
+    auto pos = fWriteBacks.find( serverName );
+    if ( pos == fWriteBacks.end() )
+        return;
+
+    auto &&writeBack = ( *pos ).second;
+    if ( writeBack.fOutstandingVerifies > 0 )
+        writeBack.fOutstandingVerifies--;
+
+    if ( ( writeBack.fOutstandingWrites == 0 ) && ( writeBack.fOutstandingVerifies == 0 ) )
+        fWriteBacks.erase( pos );
 }
 
 void CSyncSystem::slotProcessUsers()
@@ -662,11 +897,10 @@ void CSyncSystem::requestUpdateUserData( const QString &serverName, std::shared_
     // qDebug() << url;
 
     auto request = QNetworkRequest( url );
-    auto reply = makeRequest( request, ENetworkRequestType::ePost, data );
-
-    setServerName( reply, serverName );
-    setExtraData( reply, userID );
-    setRequestType( reply, ERequestType::eUpdateUserData );
+    setServerName( request, serverName );
+    setExtraData( request, userID );
+    setRequestType( request, ERequestType::eUpdateUserData );
+    makeRequest( request, ENetworkRequestType::ePost, data );
 }
 
 void CSyncSystem::handleUpdateUserData( const QString &serverName, const QString &userID )
@@ -674,11 +908,9 @@ void CSyncSystem::handleUpdateUserData( const QString &serverName, const QString
     requestGetUser( serverName, userID );
 }
 
-void CSyncSystem::setServerName( QNetworkReply *reply, const QString &serverName )
+void CSyncSystem::setServerName( QNetworkRequest &request, const QString &serverName )
 {
-    if ( !reply )
-        return;
-    fAttributes[ reply ][ kServerName ] = serverName;
+    request.setAttribute( static_cast< QNetworkRequest::Attribute >( kServerName ), serverName );
 }
 
 QString CSyncSystem::serverName( QNetworkReply *reply )
@@ -688,12 +920,10 @@ QString CSyncSystem::serverName( QNetworkReply *reply )
     return fAttributes[ reply ][ kServerName ].toString();
 }
 
-void CSyncSystem::setRequestType( QNetworkReply *reply, ERequestType requestType )
+void CSyncSystem::setRequestType( QNetworkRequest &request, ERequestType requestType )
 {
-    if ( !reply )
-        return;
-    fAttributes[ reply ][ kRequestType ] = static_cast< int >( requestType );
-    fRequests[ requestType ][ hostName( reply ) ]++;
+    request.setAttribute( static_cast< QNetworkRequest::Attribute >( kRequestType ), static_cast< int >( requestType ) );
+    fRequests[ requestType ][ hostName( request.url() ) ]++;
 }
 
 QString CSyncSystem::hostName( QNetworkReply *reply )
@@ -701,7 +931,11 @@ QString CSyncSystem::hostName( QNetworkReply *reply )
     if ( !reply )
         return {};
 
-    auto url = reply->url();
+    return hostName( reply->url() );
+}
+
+QString CSyncSystem::hostName( const QUrl &url )
+{
     auto retVal = url.toString( QUrl::RemovePath | QUrl::RemoveQuery );
     return retVal;
 }
@@ -711,11 +945,9 @@ ERequestType CSyncSystem::requestType( QNetworkReply *reply )
     return static_cast< ERequestType >( fAttributes[ reply ][ kRequestType ].toInt() );
 }
 
-void CSyncSystem::setExtraData( QNetworkReply *reply, QVariant extraData )
+void CSyncSystem::setExtraData( QNetworkRequest &request, QVariant extraData )
 {
-    if ( !reply )
-        return;
-    fAttributes[ reply ][ kExtraData ] = extraData;
+    request.setAttribute( static_cast< QNetworkRequest::Attribute >( kExtraData ), extraData );
 }
 
 QVariant CSyncSystem::extraData( QNetworkReply *reply )
@@ -726,12 +958,17 @@ QVariant CSyncSystem::extraData( QNetworkReply *reply )
 }
 
 void CSyncSystem::decRequestCount( QNetworkReply *reply, ERequestType requestType )
+{
+    decRequestCount( hostName( reply ), requestType );
+}
+
+void CSyncSystem::decRequestCount( const QString &hostName, ERequestType requestType )
 {
     auto pos = fRequests.find( requestType );
     if ( pos == fRequests.end() )
         return;
 
-    auto pos2 = ( *pos ).second.find( hostName( reply ) );
+    auto pos2 = ( *pos ).second.find( hostName );
     if ( pos2 == ( *pos ).second.end() )
         return;
 
@@ -753,7 +990,7 @@ void CSyncSystem::postHandleRequest( QNetworkReply *reply, const QString &server
     if ( !isRunning() )
     {
         fProgressSystem->resetProgress();
-        if ( ( requestType == ERequestType::eReloadMediaData ) || ( requestType == ERequestType::eUpdateUserMediaData ) )
+        if ( ( requestType == ERequestType::eReloadMediaData ) || ( requestType == ERequestType::eUpdateUserMediaData ) || ( requestType == ERequestType::eVerifyUserMediaData ) )
             emit sigProcessingFinished( currUser().second->userName( serverName ) );
     }
 }
@@ -867,7 +1104,7 @@ void CSyncSystem::slotSSlErrors( QNetworkReply * /*reply*/, const QList< QSslErr
     // qDebug() << "slotSSlErrors: 0x" << Qt::hex << reply << errors;
 }
 
-QNetworkReply *CSyncSystem::makeRequest( QNetworkRequest &request, ENetworkRequestType requestType, const QByteArray &data, QString contentType )
+void CSyncSystem::makeRequest( QNetworkRequest &request, ENetworkRequestType requestType, const QByteArray &data, QString contentType )
 {
     if ( !fPendingRequestTimer )
     {
@@ -879,23 +1116,133 @@ QNetworkReply *CSyncSystem::makeRequest( QNetworkRequest &request, ENetworkReque
     fPendingRequestTimer->start();
 
     request.setAttribute( QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy );
+    if ( requestType == ENetworkRequestType::ePost )
+    {
+        if ( contentType.isEmpty() )
+            contentType = "application/json";
+        request.setHeader( QNetworkRequest::ContentTypeHeader, contentType );
+    }
+
+    auto priority = requestPriority( static_cast< ERequestType >( request.attribute( static_cast< QNetworkRequest::Attribute >( kRequestType ) ).toInt() ) );
+    fHostQueues[ hostName( request.url() ) ].fPending[ priority ].push_back( { request, requestType, data } );
+    dispatchPendingRequests();
+}
 
+int CSyncSystem::requestPriority( ERequestType requestType )
+{
     switch ( requestType )
+    {
+        case ERequestType::eTestServer:
+        case ERequestType::eGetServerInfo:
+        case ERequestType::eGetServerHomePage:
+        case ERequestType::eGetServerIcon:
+        case ERequestType::eGetUsers:
+        case ERequestType::eGetUser:
+        case ERequestType::eGetUserAvatar:
+        case ERequestType::eReloadMediaData:
+            return 0;
+        case ERequestType::eGetMediaList:
+        case ERequestType::eGetMediaListPage:
+        case ERequestType::eGetMediaListDelta:
+        case ERequestType::eGetMediaUserData:
+        case ERequestType::eGetMediaUserDataPage:
+        case ERequestType::eGetMissingEpisodes:
+        case ERequestType::eGetMissingTVDBid:
+        case ERequestType::eGetAllMovies:
+        case ERequestType::eGetAllCollections:
+        case ERequestType::eGetAllCollectionsEx:
+        case ERequestType::eGetCollection:
+        case ERequestType::eVerifyUserMediaData:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+// sends queued requests, one per host per pass so a single busy server cannot starve the others
+// the slots come from the request budget, which may be shared with other sync systems
+void CSyncSystem::dispatchPendingRequests()
+{
+    if ( fDispatching )
+        return;
+    fDispatching = true;
+
+    bool sentOne = true;
+    while ( sentOne )
+    {
+        sentOne = false;
+        for ( auto &&ii : fHostQueues )
+        {
+            auto &&queue = ii.second;
+            auto pos = std::find_if( queue.fPending.begin(), queue.fPending.end(), []( const std::list< SPendingRequest > &pending ) { return !pending.empty(); } );
+            if ( pos == queue.fPending.end() )
+                continue;
+
+            if ( !fRequestBudget->tryAcquire( ii.first, this ) )
+                continue;
+
+            auto pendingRequest = ( *pos ).front();
+            ( *pos ).pop_front();
+            if ( sendRequest( pendingRequest ) )
+                queue.fInFlight++;
+            else
+                fRequestBudget->release( ii.first );
+            sentOne = true;
+        }
+    }
+    fDispatching = false;
+}
+
+QNetworkReply *CSyncSystem::sendRequest( const SPendingRequest &pendingRequest )
+{
+    auto requestType = static_cast< ERequestType >( pendingRequest.fRequest.attribute( static_cast< QNetworkRequest::Attribute >( kRequestType ) ).toInt() );
+
+    QNetworkReply *reply = nullptr;
+    QString method;
+    switch ( pendingRequest.fNetworkRequestType )
     {
         case ENetworkRequestType::eDeleteResource:
-            return fManager->deleteResource( request );
+            method = "DELETE";
+            reply = fManager->deleteResource( pendingRequest.fRequest );
+            break;
         case ENetworkRequestType::ePost:
-            {
-                if ( contentType.isEmpty() )
-                    contentType = "application/json";
-                request.setHeader( QNetworkRequest::ContentTypeHeader, contentType );
-                return fManager->post( request, data );
-            }
+            method = "POST";
+            reply = fManager->post( pendingRequest.fRequest, pendingRequest.fData );
+            break;
         case ENetworkRequestType::eGet:
-            return fManager->get( request );
+            method = "GET";
+            reply = fManager->get( pendingRequest.fRequest );
+            break;
         default:
-            return nullptr;
+            break;
     }
+
+    if ( !reply )
+    {
+        decRequestCount( hostName( pendingRequest.fRequest.url() ), requestType );
+        return nullptr;
+    }
+
+    qCDebug( lcNetwork ).noquote() << method << toString( requestType ) << pendingRequest.fRequest.url().toString( QUrl::RemoveQuery );
+    NLogging::captureRequest( toString( requestType ), pendingRequest.fRequest, method, pendingRequest.fData );
+
+    for ( auto &&ii : { kServerName, kRequestType, kExtraData } )
+        fAttributes[ reply ][ ii ] = pendingRequest.fRequest.attribute( static_cast< QNetworkRequest::Attribute >( ii ) );
+    return reply;
+}
+
+void CSyncSystem::clearPendingRequests()
+{
+    for ( auto &&ii : fHostQueues )
+    {
+        for ( auto &&pending : ii.second.fPending )
+        {
+            for ( auto &&jj : pending )
+                decRequestCount( ii.first, static_cast< ERequestType >( jj.fRequest.attribute( static_cast< QNetworkRequest::Attribute >( kRequestType ) ).toInt() ) );
+            pending.clear();
+        }
+    }
+    fRequestBudget->removeClient( this );   // a turn it no longer needs would hold up the other sync systems
 }
 
 std::shared_ptr< CUserData > CSyncSystem::loadUser( const QString &serverName, const QJsonObject &userData )
@@ -914,6 +1261,23 @@ bool CSyncSystem::isLastRequestOfType( ERequestType type ) const
     return cnt <= 1;
 }
 
+bool CSyncSystem::isLastMediaListRequest( const QString &host ) const
+{
+    int cnt = 0;
+    for ( auto &&type : { ERequestType::eGetMediaList, ERequestType::eGetMediaListPage, ERequestType::eGetMediaListDelta, ERequestType::eGetMediaUserData, ERequestType::eGetMediaUserDataPage } )
+    {
+        auto pos = fRequests.find( type );
+        if ( pos == fRequests.end() )
+            continue;
+        for ( auto &&jj : ( *pos ).second )
+        {
+            if ( host.isEmpty() || ( jj.first == host ) )
+                cnt += jj.second;
+        }
+    }
+    return cnt <= 1;
+}
+
 // functions to handle the responses from the servers
 bool CSyncSystem::handleError( QNetworkReply *reply, const QString &serverName, QString &errorMsg, bool reportMsg )
 {
@@ -944,11 +1308,22 @@ void CSyncSystem::slotRequestFinished( QNetworkReply *reply )
     auto requestType = this->requestType( reply );
     auto extraData = this->extraData( reply );
 
+    qCDebug( lcNetwork ).noquote() << "Finished" << toString( requestType ) << reply->url().toString( QUrl::RemoveQuery ) << reply->error();
+    if ( NLogging::captureEnabled() )
+        NLogging::captureResponse( toString( requestType ), reply, reply->peek( reply->bytesAvailable() ) );
+
     auto pos = fAttributes.find( reply );
     if ( pos != fAttributes.end() )
     {
         fAttributes.erase( pos );
+        auto queuePos = fHostQueues.find( hostName( reply ) );
+        if ( ( queuePos != fHostQueues.end() ) && ( ( *queuePos ).second.fInFlight > 0 ) )
+        {
+            ( *queuePos ).second.fInFlight--;
+            fRequestBudget->release( ( *queuePos ).first );
+        }
     }
+    dispatchPendingRequests();
 
     // emit sigAddToLog( EMsgType::eInfo, QString( "Request Completed: %1" ).arg( reply->url().toString() ) );
     // emit sigAddToLog( EMsgType::eInfo, QString( "Is LHS? %1" ).arg( serverName ? "Yes" : "No" ) );
@@ -971,6 +1346,14 @@ void CSyncSystem::slotRequestFinished( QNetworkReply *reply )
             case ERequestType::eSetUserAvatar:
                 break;
             case ERequestType::eGetMediaList:
+            case ERequestType::eGetMediaListPage:
+            case ERequestType::eGetMediaListDelta:
+            case ERequestType::eGetMediaUserData:
+            case ERequestType::eGetMediaUserDataPage:
+                fMediaPageInfo.erase( serverName );
+                fMediaDeltaRequests.erase( serverName );
+                fMediaCacheSyncTime.erase( serverName );
+                finishLibraryStructureLoad( serverName, false );
                 emit sigUserMediaLoaded();
                 break;
             case ERequestType::eGetMissingEpisodes:
@@ -988,10 +1371,15 @@ void CSyncSystem::slotRequestFinished( QNetworkReply *reply )
             case ERequestType::eGetCollection:
                 emit sigAllCollectionsLoaded();
                 break;
-            case ERequestType::eNone:
-            case ERequestType::eReloadMediaData:
             case ERequestType::eUpdateUserMediaData:
             case ERequestType::eUpdateFavorite:
+                finishWriteBack( serverName );
+                break;
+            case ERequestType::eVerifyUserMediaData:
+                finishVerifyUserMediaData( serverName );
+                break;
+            case ERequestType::eNone:
+            case ERequestType::eReloadMediaData:
             case ERequestType::eTestServer:
                 emit sigTestServerResults( serverName, false, errorMsg );
             case ERequestType::eDeleteConnectedID:
@@ -1037,22 +1425,41 @@ void CSyncSystem::slotRequestFinished( QNetworkReply *reply )
             handleGetUserResponse( serverName, data );
             break;
         case ERequestType::eGetUserAvatar:
-            handleGetUserAvatarResponse( serverName, extraData.toString(), data );
+        {
+            auto extraStrings = extraData.toStringList();
+            handleGetUserAvatarResponse( serverName, extraStrings.value( 0 ), extraStrings.value( 1 ), data );
             break;
+        }
         case ERequestType::eSetUserAvatar:
             handleSetUserAvatarResponse( serverName, extraData.toString() );
             break;
         case ERequestType::eGetMediaList:
+        case ERequestType::eGetMediaListPage:
+        case ERequestType::eGetMediaListDelta:
+        case ERequestType::eGetMediaUserData:
+        case ERequestType::eGetMediaUserDataPage:
             if ( !fProgressSystem->wasCanceled() )
             {
-                handleGetMediaListResponse( serverName, data );
-
-                if ( isLastRequestOfType( ERequestType::eGetMediaList ) )
+                switch ( requestType )
                 {
-                    fProgressSystem->resetProgress();
-                    slotMergeMedia( requestType );
+                    case ERequestType::eGetMediaListPage:
+                    case ERequestType::eGetMediaUserDataPage:
+                        handleGetMediaListPageResponse( serverName, data, extraData.toInt() );
+                        break;
+                    case ERequestType::eGetMediaListDelta:
+                        handleGetMediaListDeltaResponse( serverName, data );
+                        break;
+                    case ERequestType::eGetMediaUserData:
+                        handleGetMediaUserDataResponse( serverName, data );
+                        break;
+                    default:
+                        handleGetMediaListResponse( serverName, data );
+                        break;
                 }
+                checkMediaListLoaded( serverName, hostName( reply ) );
             }
+            else
+                finishLibraryStructureLoad( serverName, false );
             break;
         case ERequestType::eGetMissingEpisodes:
             {
@@ -1171,6 +1578,11 @@ void CSyncSystem::slotRequestFinished( QNetworkReply *reply )
                 handleCreateCollection( serverName, data );
                 break;
             }
+        case ERequestType::eVerifyUserMediaData:
+            {
+                handleVerifyUserMediaDataResponse( serverName, data );
+                break;
+            }
     }
     postHandleRequest( reply, serverName, requestType );
 }
@@ -1191,9 +1603,9 @@ void CSyncSystem::requestTestServer( std::shared_ptr< const CServerInfo > server
 
     auto request = QNetworkRequest( url );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverInfo->keyName() );
-    setRequestType( reply, ERequestType::eTestServer );
+    setServerName( request, serverInfo->keyName() );
+    setRequestType( request, ERequestType::eTestServer );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleTestServer( const QString &serverName )
@@ -1223,9 +1635,9 @@ void CSyncSystem::requestGetServerInfo( const QString &serverName )
 
     auto request = QNetworkRequest( url );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetServerInfo );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetServerInfo );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleGetServerInfoResponse( const QString &serverName, const QByteArray &data )
@@ -1258,9 +1670,9 @@ void CSyncSystem::requestGetServerHomePage( const QString &serverName )
 
     auto request = QNetworkRequest( url );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetServerHomePage );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetServerHomePage );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleGetServerHomePageResponse( const QString &serverName, const QByteArray &data )
@@ -1295,10 +1707,10 @@ void CSyncSystem::requestGetServerIcon( const QString &serverName, const QString
 
     auto request = QNetworkRequest( url );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setExtraData( reply, type );
-    setRequestType( reply, ERequestType::eGetServerIcon );
+    setServerName( request, serverName );
+    setExtraData( request, type );
+    setRequestType( request, ERequestType::eGetServerIcon );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleGetServerIconResponse( const QString &serverName, const QByteArray &data, const QString &type )
@@ -1319,9 +1731,9 @@ void CSyncSystem::requestGetUsers( const QString &serverName )
 
     auto request = QNetworkRequest( url );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetUsers );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetUsers );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleGetUsersResponse( const QString &serverName, const QByteArray &data )
@@ -1369,9 +1781,9 @@ void CSyncSystem::requestGetUser( const QString &serverName, const QString &user
 
     auto request = QNetworkRequest( url );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetUser );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetUser );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleGetUserResponse( const QString &serverName, const QByteArray &data )
@@ -1397,8 +1809,17 @@ void CSyncSystem::handleGetUserResponse( const QString &serverName, const QByteA
     }
 }
 
-void CSyncSystem::requestGetUserAvatar( const QString &serverName, const QString &userID )
+void CSyncSystem::requestGetUserAvatar( const QString &serverName, const QString &userID, bool useCache )
 {
+    QString imageTag;
+    if ( useCache )
+    {
+        auto user = fUsersModel->userDataOnServer( serverName, userID );
+        imageTag = user ? std::get< 0 >( user->getAvatarInfo( serverName ) ) : QString();
+        if ( fAvatarCache->load( serverName, userID, imageTag ) )
+            return;
+    }
+
     emit sigAddToLog( EMsgType::eInfo, tr( "Loading user image from server '%1'" ).arg( serverName ) );
 
     // UserService
@@ -1407,20 +1828,20 @@ void CSyncSystem::requestGetUserAvatar( const QString &serverName, const QString
         return;
     auto request = QNetworkRequest( url );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetUserAvatar );
-    setExtraData( reply, userID );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetUserAvatar );
+    setExtraData( request, QStringList() << userID << imageTag );
+    makeRequest( request );
 }
 
-void CSyncSystem::handleGetUserAvatarResponse( const QString &serverName, const QString &userID, const QByteArray &data )
+void CSyncSystem::handleGetUserAvatarResponse( const QString &serverName, const QString &userID, const QString &imageTag, const QByteArray &data )
 {
     auto user = fUsersModel->userDataOnServer( serverName, userID );
     if ( !user )
         return;
 
     emit sigAddToLog( EMsgType::eInfo, tr( "Setting user image from server '%1' for '%2'" ).arg( serverName ).arg( user->name( serverName ) ) );
-    fUsersModel->setUserAvatar( serverName, userID, data );
+    fAvatarCache->add( serverName, userID, imageTag, data );
 }
 
 void CSyncSystem::requestSetUserAvatar( const QString &serverName, const QString &userID, const QImage &image )
@@ -1438,15 +1859,15 @@ void CSyncSystem::requestSetUserAvatar( const QString &serverName, const QString
     buffer.open( QIODevice::WriteOnly );
     image.save( &buffer, "PNG" );   // writes image into ba in PNG format
 
-    auto reply = makeRequest( request, ENetworkRequestType::ePost, data.toBase64(), "image/png" );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eSetUserAvatar );
-    setExtraData( reply, userID );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eSetUserAvatar );
+    setExtraData( request, userID );
+    makeRequest( request, ENetworkRequestType::ePost, data.toBase64(), "image/png" );
 }
 
 void CSyncSystem::handleSetUserAvatarResponse( const QString &serverName, const QString &userID )
 {
-    requestGetUserAvatar( serverName, userID );
+    requestGetUserAvatar( serverName, userID, false );   // the image tag changed with the upload, it is only known after the user is reloaded
 }
 
 static QString kForceDelete = "<FORCE DELETE>";
@@ -1542,9 +1963,9 @@ void CSyncSystem::requestDeleteConnectedID( const QString &serverName )
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Deleting ConnectID for User '%1' from server '%2'" ).arg( fCurrUserConnectID.fUserData->userName( serverName ) ).arg( serverName ) );
 
-    auto reply = makeRequest( request, ENetworkRequestType::eDeleteResource );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eDeleteConnectedID );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eDeleteConnectedID );
+    makeRequest( request, ENetworkRequestType::eDeleteResource );
 }
 
 void CSyncSystem::handleDeleteConnectedID( const QString &serverName )
@@ -1577,9 +1998,9 @@ void CSyncSystem::requestSetConnectedID( const QString &serverName )
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Setting ConnectID for User '%1' from server '%2' to '%3'" ).arg( fCurrUserConnectID.fUserData->userName( serverName ) ).arg( serverName ).arg( fCurrUserConnectID.fConnectID.second ) );
 
-    auto reply = makeRequest( request, ENetworkRequestType::ePost );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eSetConnectedID );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eSetConnectedID );
+    makeRequest( request, ENetworkRequestType::ePost );
 }
 
 void CSyncSystem::handleSetConnectedID( const QString &serverName )
@@ -1610,12 +2031,54 @@ QString CSyncSystem::getItemFields() const
     return retVal;
 }
 
+std::list< std::pair< QString, QString > > CSyncSystem::getMediaListQueryItems() const
+{
+    return { std::make_pair( "IncludeItemTypes", fSettings->getSyncItemTypes() ), std::make_pair( "SortBy", "Type,ProductionYear,PremiereDate,SortName" ), std::make_pair( "SortOrder", "Ascending" ), std::make_pair( "Recursive", "True" ), std::make_pair( "IsMissing", "False" ), std::make_pair( "Fields", getItemFields() ) };
+}
+
 void CSyncSystem::requestGetMediaList( const QString &serverName )
 {
     if ( !currUser().second )
         return;
 
-    std::list< std::pair< QString, QString > > queryItems = { std::make_pair( "IncludeItemTypes", fSettings->getSyncItemTypes() ), std::make_pair( "SortBy", "Type,ProductionYear,PremiereDate,SortName" ), std::make_pair( "SortOrder", "Ascending" ), std::make_pair( "Recursive", "True" ), std::make_pair( "IsMissing", "False" ), std::make_pair( "Fields", getItemFields() ) };
+    if ( useLibraryStructure() )
+    {
+        switch ( fLibraryStructure->state( serverName ) )
+        {
+            case CLibraryStructure::EState::eLoaded:
+                requestGetMediaUserData( serverName );
+                return;
+            case CLibraryStructure::EState::eLoading:
+                waitForLibraryStructure( serverName );
+                return;
+            case CLibraryStructure::EState::eNotLoaded:
+                fLibraryStructure->startLoad( serverName );
+                fLibraryStructureLoads.insert( serverName );
+                break;
+        }
+    }
+
+    if ( useMediaCache() )
+    {
+        auto &&userID = currUser().second->getUserID( serverName );
+        fMediaCacheSyncTime[ serverName ] = QDateTime::currentDateTimeUtc();
+        if ( fMediaCache->load( serverName, userID, mediaCacheQueryKey(), fSettings->mediaCacheMaxAgeDays() ) )
+        {
+            requestGetMediaListDelta( serverName );
+            return;
+        }
+        fMediaCache->reset( serverName, userID );
+    }
+
+    if ( fSettings->mediaPageSize() > 0 )
+    {
+        // the first page reports the total count, the remaining pages are requested as the responses arrive
+        fMediaPageInfo[ serverName ] = SMediaPageInfo();
+        requestGetMediaListPage( serverName );
+        return;
+    }
+
+    auto queryItems = getMediaListQueryItems();
 
     // ItemsService
     auto &&url = fServerModel->findServerInfo( serverName )->getUrl( QString( "Users/%1/Items" ).arg( currUser().second->getUserID( serverName ) ), queryItems );
@@ -1627,14 +2090,404 @@ void CSyncSystem::requestGetMediaList( const QString &serverName )
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Requesting media for '%1' from server '%2'" ).arg( currUser().second->userName( serverName ) ).arg( serverName ) );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetMediaList );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetMediaList );
+    makeRequest( request );
+}
+
+// returns false when there are no more pages to request from the server
+bool CSyncSystem::requestGetMediaListPage( const QString &serverName )
+{
+    if ( !currUser().second )
+        return false;
+
+    auto pos = fMediaPageInfo.find( serverName );
+    if ( pos == fMediaPageInfo.end() )
+        return false;
+
+    auto &&pageInfo = ( *pos ).second;
+    if ( ( pageInfo.fTotalRecordCount >= 0 ) && ( pageInfo.fNextStartIndex >= pageInfo.fTotalRecordCount ) )
+        return false;
+    if ( ( fSettings->maxItems() > 0 ) && ( pageInfo.fNextStartIndex >= fSettings->maxItems() ) )
+        return false;
+
+    auto startIndex = pageInfo.fNextStartIndex;
+    auto pageSize = fSettings->mediaPageSize();
+    if ( fSettings->maxItems() > 0 )
+        pageSize = std::min( pageSize, fSettings->maxItems() - startIndex );
+
+    auto isUserData = ( pageInfo.fRequestType == ERequestType::eGetMediaUserDataPage );
+    auto queryItems = isUserData ? getMediaUserDataQueryItems() : getMediaListQueryItems();
+    queryItems.emplace_back( "StartIndex", QString::number( startIndex ) );
+    queryItems.emplace_back( "Limit", QString::number( pageSize ) );
+    queryItems.emplace_back( "EnableTotalRecordCount", "True" );
+
+    // ItemsService
+    auto &&url = fServerModel->findServerInfo( serverName )->getUrl( QString( "Users/%1/Items" ).arg( currUser().second->getUserID( serverName ) ), queryItems );
+    if ( !url.isValid() )
+        return false;
+
+    pageInfo.fNextStartIndex += pageSize;
+    pageInfo.fPagesInFlight++;
+
+    // qDebug().noquote().nospace() << url;
+    auto request = QNetworkRequest( url );
+
+    emit sigAddToLog( EMsgType::eInfo, QString( "Requesting %5 %3-%4 for '%1' from server '%2'" ).arg( currUser().second->userName( serverName ) ).arg( serverName ).arg( startIndex + 1 ).arg( startIndex + pageSize ).arg( isUserData ? "the play state of media" : "media" ) );
+
+    setServerName( request, serverName );
+    setExtraData( request, startIndex );
+    setRequestType( request, pageInfo.fRequestType );
+    makeRequest( request );
+    return true;
 }
 
 void CSyncSystem::handleGetMediaListResponse( const QString &serverName, const QByteArray &data )
 {
-    handleGetMediaListResponse( serverName, data, tr( "Loading Users Media Data" ), tr( "%1 has %2 media items on server '%3'" ), tr( "Loading %2 media items" ) );
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson( data, &error );
+    if ( error.error != QJsonParseError::NoError )
+    {
+        if ( fUserMsgFunc )
+            fUserMsgFunc( EMsgType::eError, tr( "Invalid Response" ), tr( "Invalid Response from Server: %1 - %2" ).arg( error.errorString() ).arg( QString( data ) ).arg( error.offset ) );
+        fMediaCacheSyncTime.erase( serverName );
+        finishLibraryStructureLoad( serverName, false );
+        return;
+    }
+
+    auto mediaArray = toItemArray( doc );
+    cacheMediaArray( serverName, mediaArray );
+    if ( useLibraryStructure() )
+        fLibraryStructure->addItems( serverName, mediaArray );
+    loadMediaArrayAsync( mediaArray, serverName, tr( "Loading Users Media Data" ), tr( "%1 has %2 media items on server '%3'" ), tr( "Loading %2 media items" ) );
+}
+
+bool CSyncSystem::useMediaCache() const
+{
+    // partial loads would poison the cache
+    return fSettings->cacheMedia() && ( fSettings->maxItems() <= 0 ) && currUser().second;
+}
+
+QString CSyncSystem::mediaCacheQueryKey() const
+{
+    return QString( "%1|%2" ).arg( fSettings->getSyncItemTypes() ).arg( getItemFields() );
+}
+
+void CSyncSystem::cacheMediaArray( const QString &serverName, const QJsonArray &mediaArray )
+{
+    if ( fMediaCacheSyncTime.find( serverName ) == fMediaCacheSyncTime.end() )
+        return;
+    fMediaCache->addItems( serverName, currUser().second->getUserID( serverName ), mediaArray );
+}
+
+void CSyncSystem::saveMediaCache()
+{
+    for ( auto &&ii : fMediaCacheSyncTime )
+    {
+        if ( !fMediaCache->save( ii.first, currUser().second->getUserID( ii.first ), mediaCacheQueryKey(), ii.second ) )
+            emit sigAddToLog( EMsgType::eWarning, tr( "Could not save the media cache for server '%1'" ).arg( ii.first ) );
+    }
+    fMediaCacheSyncTime.clear();
+    fMediaDeltaRequests.clear();
+    fMediaCache->clear();
+}
+
+bool CSyncSystem::useLibraryStructure() const
+{
+    // partial loads would leave items out of the shared structure
+    return fLibraryStructure && ( fSettings->maxItems() <= 0 ) && currUser().second;
+}
+
+// another sync system is loading the structure for the server, the media list stays pending until it is done
+void CSyncSystem::waitForLibraryStructure( const QString &serverName )
+{
+    emit sigAddToLog( EMsgType::eInfo, QString( "Waiting for the library structure of server '%1' to load the play state for '%2'" ).arg( serverName ).arg( currUser().second->userName( serverName ) ) );
+    fLibraryStructureWaits.insert( serverName );
+    fRequests[ ERequestType::eGetMediaList ][ hostName( fServerModel->findServerInfo( serverName )->getUrl() ) ]++;   // keeps the merge from starting without this server
+}
+
+void CSyncSystem::slotLibraryStructureLoaded( const QString &serverName, bool aOK )
+{
+    if ( fLibraryStructureWaits.erase( serverName ) == 0 )
+        return;
+
+    // a failed structure load falls back to this user loading the full items
+    if ( aOK )
+        requestGetMediaUserData( serverName );
+    else
+        requestGetMediaList( serverName );
+    decRequestCount( hostName( fServerModel->findServerInfo( serverName )->getUrl() ), ERequestType::eGetMediaList );
+}
+
+// the follow up pages, item requests and decodes are counted before the caller is released, so once it is the last one the servers items are all in
+void CSyncSystem::checkMediaListLoaded( const QString &serverName, const QString &host )
+{
+    if ( isLastMediaListRequest( host ) )
+        finishLibraryStructureLoad( serverName, true );
+
+    if ( isLastMediaListRequest() )
+    {
+        fMediaPageInfo.clear();
+        saveMediaCache();
+        fProgressSystem->resetProgress();
+        slotMergeMedia( ERequestType::eGetMediaList );
+    }
+}
+
+void CSyncSystem::finishLibraryStructureLoad( const QString &serverName, bool aOK )
+{
+    if ( fLibraryStructureLoads.erase( serverName ) == 0 )
+        return;
+    fLibraryStructure->finishLoad( serverName, aOK );
+}
+
+// the play state projection, only the IDs and user data of the items, the rest comes from the shared structure
+std::list< std::pair< QString, QString > > CSyncSystem::getMediaUserDataQueryItems() const
+{
+    auto retVal = getMediaListQueryItems();
+    for ( auto &&ii : retVal )
+    {
+        if ( ii.first == "Fields" )
+            ii.second = "Id";
+    }
+    retVal.emplace_back( "EnableImages", "False" );
+    retVal.emplace_back( "EnableUserData", "True" );
+    return retVal;
+}
+
+void CSyncSystem::requestGetMediaUserData( const QString &serverName )
+{
+    if ( fSettings->mediaPageSize() > 0 )
+    {
+        // paged the same way as the full items
+        SMediaPageInfo pageInfo;
+        pageInfo.fRequestType = ERequestType::eGetMediaUserDataPage;
+        fMediaPageInfo[ serverName ] = pageInfo;
+        requestGetMediaListPage( serverName );
+        return;
+    }
+
+    auto queryItems = getMediaUserDataQueryItems();
+
+    // ItemsService
+    auto &&url = fServerModel->findServerInfo( serverName )->getUrl( QString( "Users/%1/Items" ).arg( currUser().second->getUserID( serverName ) ), queryItems );
+    if ( !url.isValid() )
+        return;
+
+    auto request = QNetworkRequest( url );
+
+    emit sigAddToLog( EMsgType::eInfo, QString( "Requesting the play state for '%1' from server '%2'" ).arg( currUser().second->userName( serverName ) ).arg( serverName ) );
+
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetMediaUserData );
+    makeRequest( request );
+}
+
+void CSyncSystem::handleGetMediaUserDataResponse( const QString &serverName, const QByteArray &data )
+{
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson( data, &error );
+    if ( error.error != QJsonParseError::NoError )
+    {
+        if ( fUserMsgFunc )
+            fUserMsgFunc( EMsgType::eError, tr( "Invalid Response" ), tr( "Invalid Response from Server: %1 - %2" ).arg( error.errorString() ).arg( QString( data ) ).arg( error.offset ) );
+        return;
+    }
+
+    loadMediaUserData( serverName, toItemArray( doc ), tr( "Loading Users Play State" ) );
+}
+
+void CSyncSystem::loadMediaUserData( const QString &serverName, const QJsonArray &userDataItems, const QString &progressTitle )
+{
+    QStringList missingIDs;
+    auto mediaArray = fLibraryStructure->applyUserData( serverName, userDataItems, missingIDs );
+    loadMediaArrayAsync( mediaArray, serverName, progressTitle, tr( "Server '%1' returned the play state of %2 media items" ), tr( "Loading %2 media items" ) );
+
+    // items the user can see that were not in the structure, eg a library the first user has no access to
+    if ( !missingIDs.isEmpty() )
+    {
+        emit sigAddToLog( EMsgType::eInfo, tr( "Server '%1' has %2 media items for '%3' that are not in the library structure, requesting them" ).arg( serverName ).arg( missingIDs.count() ).arg( currUser().second->userName( serverName ) ) );
+        requestGetMediaListItems( serverName, missingIDs );
+    }
+}
+
+// full items by ID, the responses are handled as a regular unpaged media list
+void CSyncSystem::requestGetMediaListItems( const QString &serverName, const QStringList &mediaIDs )
+{
+    const int kIDsPerRequest = 100;   // keeps the url a reasonable length
+    for ( int ii = 0; ii < mediaIDs.count(); ii += kIDsPerRequest )
+    {
+        auto queryItems = getMediaListQueryItems();
+        queryItems.emplace_back( "Ids", mediaIDs.mid( ii, kIDsPerRequest ).join( "," ) );
+
+        // ItemsService
+        auto &&url = fServerModel->findServerInfo( serverName )->getUrl( QString( "Users/%1/Items" ).arg( currUser().second->getUserID( serverName ) ), queryItems );
+        if ( !url.isValid() )
+            return;
+
+        auto request = QNetworkRequest( url );
+
+        setServerName( request, serverName );
+        setRequestType( request, ERequestType::eGetMediaList );
+        makeRequest( request );
+    }
+}
+
+// requests the items whose metadata or user data changed since the cached snapshot was taken
+void CSyncSystem::requestGetMediaListDelta( const QString &serverName )
+{
+    auto &&userID = currUser().second->getUserID( serverName );
+
+    // allow for clock differences between this machine and the server, re-fetching a few items is harmless
+    auto since = fMediaCache->lastSync( serverName, userID ).addSecs( -300 ).toString( Qt::ISODate );
+    emit sigAddToLog( EMsgType::eInfo, QString( "Requesting media changed since %3 for '%1' from server '%2'" ).arg( currUser().second->userName( serverName ) ).arg( serverName ).arg( since ) );
+
+    for ( auto &&filter : { QString( "MinDateLastSaved" ), QString( "MinDateLastSavedForUser" ) } )
+    {
+        auto queryItems = getMediaListQueryItems();
+        queryItems.emplace_back( filter, since );
+
+        // ItemsService
+        auto &&url = fServerModel->findServerInfo( serverName )->getUrl( QString( "Users/%1/Items" ).arg( userID ), queryItems );
+        if ( !url.isValid() )
+            continue;
+
+        // qDebug().noquote().nospace() << url;
+        auto request = QNetworkRequest( url );
+
+        fMediaDeltaRequests[ serverName ]++;
+        setServerName( request, serverName );
+        setExtraData( request, filter );
+        setRequestType( request, ERequestType::eGetMediaListDelta );
+        makeRequest( request );
+    }
+}
+
+void CSyncSystem::handleGetMediaListDeltaResponse( const QString &serverName, const QByteArray &data )
+{
+    auto pos = fMediaDeltaRequests.find( serverName );
+    if ( pos == fMediaDeltaRequests.end() )
+        return;
+
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson( data, &error );
+    if ( error.error != QJsonParseError::NoError )
+    {
+        if ( fUserMsgFunc )
+            fUserMsgFunc( EMsgType::eError, tr( "Invalid Response" ), tr( "Invalid Response from Server: %1 - %2" ).arg( error.errorString() ).arg( QString( data ) ).arg( error.offset ) );
+        fMediaDeltaRequests.erase( pos );
+        fMediaCacheSyncTime.erase( serverName );
+        finishLibraryStructureLoad( serverName, false );
+        return;
+    }
+
+    auto mediaArray = toItemArray( doc );
+    emit sigAddToLog( EMsgType::eInfo, tr( "Server '%1' reported %2 changed media items" ).arg( serverName ).arg( mediaArray.count() ) );
+    cacheMediaArray( serverName, mediaArray );
+
+    if ( --( *pos ).second > 0 )
+        return;
+    fMediaDeltaRequests.erase( pos );
+
+    // all changes are in, load the updated snapshot as if it came from the server, a page at a time like a paged load
+    auto cachedArray = fMediaCache->items( serverName, currUser().second->getUserID( serverName ) );
+    auto pageSize = ( fSettings->mediaPageSize() > 0 ) ? fSettings->mediaPageSize() : cachedArray.count();
+    auto numPages = ( pageSize > 0 ) ? ( cachedArray.count() + pageSize - 1 ) / pageSize : 0;
+    for ( int ii = 0; ii < numPages; ++ii )
+    {
+        QJsonArray page;
+        for ( int jj = ii * pageSize; ( jj < ( ii + 1 ) * pageSize ) && ( jj < cachedArray.count() ); ++jj )
+            page.append( cachedArray.at( jj ) );
+
+        if ( useLibraryStructure() )
+            fLibraryStructure->addItems( serverName, page );
+        loadMediaArrayAsync( page, serverName, tr( "Loading Cached Users Media Data (page %1 of %2)" ).arg( ii + 1 ).arg( numPages ), tr( "Loading %2 media items of server '%1' from the local cache" ), tr( "Loading %2 media items" ) );
+    }
+}
+
+void CSyncSystem::handleGetMediaListPageResponse( const QString &serverName, const QByteArray &data, int startIndex )
+{
+    auto pos = fMediaPageInfo.find( serverName );
+    if ( pos == fMediaPageInfo.end() )
+        return;
+
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson( data, &error );
+    if ( error.error != QJsonParseError::NoError )
+    {
+        if ( fUserMsgFunc )
+            fUserMsgFunc( EMsgType::eError, tr( "Invalid Response" ), tr( "Invalid Response from Server: %1 - %2" ).arg( error.errorString() ).arg( QString( data ) ).arg( error.offset ) );
+        fMediaPageInfo.erase( pos );
+        fMediaCacheSyncTime.erase( serverName );
+        finishLibraryStructureLoad( serverName, false );
+        return;
+    }
+
+    auto &&pageInfo = ( *pos ).second;
+    pageInfo.fPagesInFlight--;
+    if ( ( pageInfo.fTotalRecordCount < 0 ) && doc[ "TotalRecordCount" ].isDouble() )
+    {
+        pageInfo.fTotalRecordCount = doc[ "TotalRecordCount" ].toInt();
+        if ( fSettings->maxItems() > 0 )
+            pageInfo.fTotalRecordCount = std::min( pageInfo.fTotalRecordCount, fSettings->maxItems() );
+        emit sigAddToLog( EMsgType::eInfo, tr( "Server '%1' has %2 media items, loading %3 at a time" ).arg( serverName ).arg( pageInfo.fTotalRecordCount ).arg( fSettings->mediaPageSize() ) );
+    }
+
+    auto mediaArray = doc[ "Items" ].toArray();
+    if ( ( pageInfo.fTotalRecordCount < 0 ) && ( mediaArray.count() < fSettings->mediaPageSize() ) )
+        pageInfo.fTotalRecordCount = startIndex + mediaArray.count();   // server didnt report a total, a short page is the last one
+
+    // items already loaded from another page are dropped, so a shifted item is not loaded twice
+    QJsonArray newItems;
+    for ( auto &&ii : mediaArray )
+    {
+        if ( pageInfo.fSeenIDs.insert( ii.toObject()[ "Id" ].toString() ).second )
+            newItems.append( ii );
+    }
+    if ( newItems.count() != mediaArray.count() )
+    {
+        qCDebug( lcSync ).noquote() << "Dropped" << ( mediaArray.count() - newItems.count() ) << "items already loaded from" << serverName;
+        mediaArray = newItems;
+    }
+
+    auto numPages = ( pageInfo.fTotalRecordCount < 0 ) ? 0 : ( pageInfo.fTotalRecordCount + fSettings->mediaPageSize() - 1 ) / fSettings->mediaPageSize();
+    ++pageInfo.fPageNum;
+    if ( pageInfo.fRequestType == ERequestType::eGetMediaUserDataPage )
+        loadMediaUserData( serverName, mediaArray, tr( "Loading Users Play State (page %1 of %2)" ).arg( pageInfo.fPageNum ).arg( numPages ) );
+    else
+    {
+        cacheMediaArray( serverName, mediaArray );
+        if ( useLibraryStructure() )
+            fLibraryStructure->addItems( serverName, mediaArray );
+        loadMediaArrayAsync( mediaArray, serverName, tr( "Loading Users Media Data (page %1 of %2)" ).arg( pageInfo.fPageNum ).arg( numPages ), tr( "Server '%1' returned %2 media items" ), tr( "Loading %2 media items" ) );
+    }
+
+    // keep the configured number of pages in flight for this server, until the whole library has been requested
+    while ( !fProgressSystem->wasCanceled() && ( pageInfo.fPagesInFlight < fSettings->mediaPagesInFlight() ) )
+    {
+        if ( !requestGetMediaListPage( serverName ) )
+            break;
+    }
+
+    if ( ( pageInfo.fPagesInFlight > 0 ) || fProgressSystem->wasCanceled() || ( static_cast< int >( pageInfo.fSeenIDs.size() ) >= pageInfo.fTotalRecordCount ) )
+        return;
+
+    // every page is in but items are missing, the order shifted while the pages were loaded
+    auto numMissing = pageInfo.fTotalRecordCount - static_cast< int >( pageInfo.fSeenIDs.size() );
+    if ( pageInfo.fPass == 1 )
+    {
+        emit sigAddToLog( EMsgType::eInfo, tr( "Server '%1' skipped %2 media items while paging, requesting the pages again" ).arg( serverName ).arg( numMissing ) );
+        pageInfo.fPass++;
+        pageInfo.fNextStartIndex = 0;
+        pageInfo.fPageNum = 0;
+        while ( pageInfo.fPagesInFlight < fSettings->mediaPagesInFlight() )
+        {
+            if ( !requestGetMediaListPage( serverName ) )
+                break;
+        }
+    }
+    else
+        emit sigAddToLog( EMsgType::eWarning, tr( "Server '%1' reported %2 media items but %3 could not be loaded" ).arg( serverName ).arg( pageInfo.fTotalRecordCount ).arg( numMissing ) );
 }
 
 QJsonArray CSyncSystem::toItemArray( QJsonDocument &doc, const std::function< void( QJsonObject &obj ) > &onObj /*= {} */ ) const
@@ -1675,7 +2528,7 @@ std::list< std::shared_ptr< CMediaData > > CSyncSystem::handleGetMissingMediaLis
         return {};
     }
 
-    qDebug().noquote().nospace() << doc.toJson();
+    qCDebug( lcSyncJson ).noquote().nospace() << doc.toJson();
     auto mediaArray = toItemArray( doc, []( QJsonObject &media ) { media.insert( "IsMissing", true ); } );
     //QJsonArray mediaArray;
     //if ( doc[ "Items" ].isArray() )
@@ -1714,35 +2567,84 @@ std::list< std::shared_ptr< CMediaData > > CSyncSystem::handleGetMediaListRespon
 
 std::list< std::shared_ptr< CMediaData > > CSyncSystem::loadMediaArray( QJsonArray &mediaArray, const QString &serverName, const QString &progressTitle, const QString &logMsg, const QString &partialLogMsg )
 {
-    qDebug().noquote().nospace() << QJsonDocument( mediaArray ).toJson();
+    qCDebug( lcSync ).noquote() << "Loading" << mediaArray.count() << "items from" << serverName;
+    qCDebug( lcSyncJson ).noquote().nospace() << QJsonDocument( mediaArray ).toJson();
 
-    auto showProgress = mediaArray.count() > 10;
+    emit sigAddToLog( EMsgType::eInfo, logMsg.arg( serverName ).arg( mediaArray.count() ) );
+    if ( fSettings->maxItems() > 0 )
+        emit sigAddToLog( EMsgType::eInfo, partialLogMsg.arg( fSettings->maxItems() ) );
+
+    // parsing is spread over the thread pool, only the insert into the model happens here
+    auto decodedMedia = CMediaModel::decodeMedia( serverName, mediaArray, fServerModel->enabledServerNames() );
+    return loadDecodedMedia( decodedMedia, serverName, progressTitle );
+}
+
+// the users media, nothing waits on the items so the event loop keeps running while they are parsed
+// each decode counts as a media list request, the merge cannot start before its items are in the model
+void CSyncSystem::loadMediaArrayAsync( const QJsonArray &mediaArray, const QString &serverName, const QString &progressTitle, const QString &logMsg, const QString &partialLogMsg )
+{
+    qCDebug( lcSync ).noquote() << "Loading" << mediaArray.count() << "items from" << serverName;
+    qCDebug( lcSyncJson ).noquote().nospace() << QJsonDocument( mediaArray ).toJson();
+
+    emit sigAddToLog( EMsgType::eInfo, logMsg.arg( serverName ).arg( mediaArray.count() ) );
+    if ( fSettings->maxItems() > 0 )
+        emit sigAddToLog( EMsgType::eInfo, partialLogMsg.arg( fSettings->maxItems() ) );
+    if ( mediaArray.isEmpty() )
+        return;
+
+    auto host = hostName( fServerModel->findServerInfo( serverName )->getUrl() );
+    fRequests[ ERequestType::eGetMediaList ][ host ]++;
+    fMediaDecodes[ host ]++;
+    auto generation = fMediaDecodeGeneration;
+    CMediaModel::decodeMedia(
+        fDecodePool.get(), serverName, mediaArray, fServerModel->enabledServerNames(),
+        [ this, serverName, host, generation, progressTitle ]( std::vector< SDecodedMedia > &decoded )
+        {
+            QMetaObject::invokeMethod(
+                this,
+                [ this, serverName, host, generation, progressTitle, decoded = std::move( decoded ) ]() mutable
+                {
+                    if ( generation != fMediaDecodeGeneration )   // canceled, the count was already released
+                        return;
+                    if ( --fMediaDecodes[ host ] == 0 )
+                        fMediaDecodes.erase( host );
+
+                    if ( fProgressSystem->wasCanceled() )
+                        finishLibraryStructureLoad( serverName, false );
+                    else
+                    {
+                        loadDecodedMedia( decoded, serverName, progressTitle );
+                        checkMediaListLoaded( serverName, host );
+                    }
+                    decRequestCount( host, ERequestType::eGetMediaList );
+                },
+                Qt::QueuedConnection );
+        } );
+}
+
+std::list< std::shared_ptr< CMediaData > > CSyncSystem::loadDecodedMedia( std::vector< SDecodedMedia > &decodedMedia, const QString &serverName, const QString &progressTitle )
+{
+    auto showProgress = decodedMedia.size() > 10;
     if ( showProgress )
     {
         fProgressSystem->pushState();
 
         fProgressSystem->resetProgress();
         fProgressSystem->setTitle( progressTitle );
-        fProgressSystem->setMaximum( mediaArray.count() );
+        fProgressSystem->setMaximum( static_cast< int >( decodedMedia.size() ) );
     }
-    emit sigAddToLog( EMsgType::eInfo, logMsg.arg( serverName ).arg( mediaArray.count() ) );
-    if ( fSettings->maxItems() > 0 )
-        emit sigAddToLog( EMsgType::eInfo, partialLogMsg.arg( fSettings->maxItems() ) );
 
-    int curr = 0;
     std::list< std::shared_ptr< CMediaData > > retVal;
     // fMediaModel->beginBatchLoad();
-    for ( auto &&ii : mediaArray )
+    for ( auto &&ii : decodedMedia )
     {
-        auto media = ii.toObject();
-        if ( CMediaData::isExtra( media ) )
+        if ( !ii.isValid() )
             continue;
         if ( fSettings->maxItems() > 0 )
         {
             if ( retVal.size() >= fSettings->maxItems() )
                 break;
         }
-        curr++;
 
         if ( showProgress )
         {
@@ -1751,7 +2653,7 @@ std::list< std::shared_ptr< CMediaData > > CSyncSystem::loadMediaArray( QJsonArr
             fProgressSystem->incProgress();
         }
 
-        auto curr = fMediaModel->loadMedia( serverName, media );
+        auto curr = fMediaModel->loadMedia( serverName, ii );
         retVal.push_back( curr );
     }
     // fMediaModel->endBatchLoad();
@@ -1791,14 +2693,14 @@ void CSyncSystem::requestMissingEpisodes( const QString &serverName  )
     if ( !url.isValid() )
         return;
 
-    qDebug().noquote().nospace() << url;
+    qCDebug( lcNetwork ).noquote().nospace() << url;
     auto request = QNetworkRequest( url );
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Requesting missing episodes from server '%2'" ).arg( serverName ) );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetMissingEpisodes );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetMissingEpisodes );
+    makeRequest( request );
 }
 
 void CSyncSystem::requestMissingTVDBid( const QString &serverName )
@@ -1818,9 +2720,9 @@ void CSyncSystem::requestMissingTVDBid( const QString &serverName )
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Requesting missing episodes from server '%2'" ).arg( serverName ) );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetMissingTVDBid );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetMissingTVDBid );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleMissingTVDBidResponse( const QString &serverName, const QByteArray &data )
@@ -1856,9 +2758,9 @@ void CSyncSystem::requestAllMovies( const QString &serverName )
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Requesting all movies from server '%2'" ).arg( serverName ) );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetAllMovies );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetAllMovies );
+    makeRequest( request );
 }
 
 bool CSyncSystem::requestCreateCollection( const QString &serverName, const QString &collectionName, const std::list< std::shared_ptr< CMediaData > > &items )
@@ -1892,9 +2794,9 @@ bool CSyncSystem::requestCreateCollection( const QString &serverName, const QStr
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Requesting to create media collection '%1' with '%3' media items on server '%2'" ).arg( collectionName ).arg( serverName ).arg( ids.count() ) );
 
-    auto reply = makeRequest( request, ENetworkRequestType::ePost );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eCreateCollection );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eCreateCollection );
+    makeRequest( request, ENetworkRequestType::ePost );
     return true;
 }
 
@@ -1924,9 +2826,9 @@ void CSyncSystem::requestAllCollections( const QString &serverName )
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Requesting all media folders from server '%2'" ).arg( serverName ) );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetAllCollections );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetAllCollections );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleAllCollectionsResponse( const QString &serverName, const QByteArray &data )
@@ -1986,10 +2888,10 @@ void CSyncSystem::requestAllCollectionsEx( const QString &serverName, const QStr
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Requesting collections from folder '%1(%2)' from server '%3'" ).arg( folderName ).arg( folderId ).arg( serverName ) );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetAllCollectionsEx );
-    setExtraData( reply, QStringList() << folderName << folderId );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetAllCollectionsEx );
+    setExtraData( request, QStringList() << folderName << folderId );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleAllCollectionsExResponse( const QString &serverName, const QByteArray &data, const QString &folderName, const QString &folderId )
@@ -2044,10 +2946,10 @@ void CSyncSystem::requestGetCollection( const QString &serverName, const QString
 
     emit sigAddToLog( EMsgType::eInfo, QString( "Requesting collection %1(%2) from server '%3'" ).arg( collectionName ).arg( collectionId ).arg( serverName ) );
 
-    auto reply = makeRequest( request );
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eGetCollection );
-    setExtraData( reply, QStringList() << collectionName << collectionId );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eGetCollection );
+    setExtraData( request, QStringList() << collectionName << collectionId );
+    makeRequest( request );
 }
 
 void CSyncSystem::handleGetCollectionResponse( const QString &serverName, const QString &collectionName, const QString &collectionId, const QByteArray &data )
@@ -2075,11 +2977,10 @@ void CSyncSystem::requestReloadMediaItemData( const QString &serverName, std::sh
     // qDebug() << url;
     auto request = QNetworkRequest( url );
 
-    auto reply = makeRequest( request );
-
-    setServerName( reply, serverName );
-    setRequestType( reply, ERequestType::eReloadMediaData );
-    setExtraData( reply, mediaData->getMediaID( serverName ) );
+    setServerName( request, serverName );
+    setRequestType( request, ERequestType::eReloadMediaData );
+    setExtraData( request, mediaData->getMediaID( serverName ) );
+    makeRequest( request );
     // qDebug() << "Media Data for " << mediaData->name() << reply;
 }
 
@@ -2100,6 +3001,24 @@ void CSyncSystem::handleReloadMediaResponse( const QString &serverName, const QB
 
 void CSyncSystem::slotCanceled()
 {
+    fWriteBacks.clear();
+    fMediaCacheSyncTime.clear();
+    fMediaDeltaRequests.clear();
+    fMediaCache->clear();
+    for ( auto &&ii : fLibraryStructureWaits )
+        decRequestCount( hostName( fServerModel->findServerInfo( ii )->getUrl() ), ERequestType::eGetMediaList );
+    fLibraryStructureWaits.clear();
+    for ( auto &&ii : fMediaDecodes )
+    {
+        for ( int jj = 0; jj < ii.second; ++jj )
+            decRequestCount( ii.first, ERequestType::eGetMediaList );
+    }
+    fMediaDecodes.clear();
+    ++fMediaDecodeGeneration;
+    auto structureLoads = fLibraryStructureLoads;
+    for ( auto &&ii : structureLoads )
+        finishLibraryStructureLoad( ii, false );
+    clearPendingRequests();
     auto tmp = fAttributes;
     for ( auto &&ii : tmp )
     {
@@ -36,6 +36,10 @@
 
 #include <memory>
 #include <set>
+#include <map>
+#include <list>
+#include <array>
+#include <vector>
 
 class CUsersModel;
 class CMediaModel;
@@ -53,10 +57,16 @@ class CMediaData;
 struct SMediaServerData;
 class CSettings;
 class CProgressSystem;
+class CMediaCache;
+class CAvatarCache;
+class CRequestBudget;
+class CLibraryStructure;
 class QTimer;
 class CServerInfo;
 struct SUserServerData;
 class QJsonValueRef;
+class QThreadPool;
+struct SDecodedMedia;
 
 enum class ETool
 {
@@ -80,6 +90,10 @@ enum class ERequestType
     eGetUserAvatar,
     eSetUserAvatar,
     eGetMediaList,
+    eGetMediaListPage,
+    eGetMediaListDelta,
+    eGetMediaUserData,
+    eGetMediaUserDataPage,
     eReloadMediaData,
     eUpdateUserMediaData,
     eUpdateFavorite,
@@ -93,7 +107,8 @@ enum class ERequestType
     eGetAllCollections,
     eGetAllCollectionsEx,
     eGetCollection,
-    eCreateCollection
+    eCreateCollection,
+    eVerifyUserMediaData
 };
 
 enum class ENetworkRequestType
@@ -120,6 +135,54 @@ struct SServerReplyInfo
     QString fExtraData;
 };
 
+struct SMediaPageInfo
+{
+    int fNextStartIndex{ 0 };
+    int fTotalRecordCount{ -1 };   // -1 until the first page reports it
+    int fPagesInFlight{ 0 };
+    int fPageNum{ 0 };
+    ERequestType fRequestType{ ERequestType::eGetMediaListPage };   // eGetMediaUserDataPage when paging the play state projection
+    std::unordered_set< QString > fSeenIDs;   // the sort key is not unique, an item can move between pages that are in flight together
+    int fPass{ 1 };   // a second pass picks up the items the first skipped
+};
+
+struct SWriteBackItem
+{
+    std::shared_ptr< CMediaData > fMediaData;   // the model keys its media by its own IDs, so the media written is kept rather than looked up
+    std::shared_ptr< SMediaServerData > fNewData;   // data written to the server
+};
+
+struct SWriteBackInfo
+{
+    std::unordered_map< QString, SWriteBackItem > fItems;   // media ID on the server -> the write
+    std::set< QString > fToVerify;   // media IDs written successfully, re-read in bulk once all writes have finished
+    int fOutstandingWrites{ 0 };
+    int fOutstandingVerifies{ 0 };
+};
+
+struct SPendingRequest
+{
+    QNetworkRequest fRequest;
+    ENetworkRequestType fNetworkRequestType{ ENetworkRequestType::eGet };
+    QByteArray fData;
+};
+
+struct SHostRequestQueue
+{
+    bool empty() const
+    {
+        for ( auto &&ii : fPending )
+        {
+            if ( !ii.empty() )
+                return false;
+        }
+        return true;
+    }
+
+    int fInFlight{ 0 };
+    std::array< std::list< SPendingRequest >, 3 > fPending;   // indexed by priority, interactive requests first
+};
+
 struct SConnectIDInfo
 {
     QString fServerName;   // empty means apply to all servers
@@ -149,10 +212,15 @@ class CSyncSystem : public QObject
     Q_OBJECT
 public:
     CSyncSystem( std::shared_ptr< CSettings > settings, std::shared_ptr< CUsersModel > usersModel, std::shared_ptr< CMediaModel > mediaModel, std::shared_ptr< CCollectionsModel > collectionsModel, std::shared_ptr< CServerModel > serverModel, QObject *parent = nullptr );
+    ~CSyncSystem();
 
     void setProcessNewMediaFunc( std::function< void( std::shared_ptr< CMediaData > userData ) > processMediaFunc );
     void setUserMsgFunc( std::function< void( EMsgType msgType, const QString &title, const QString &msg ) > userMsgFunc );
     void setProgressSystem( std::shared_ptr< CProgressSystem > funcs );
+    void setNetworkAccessManager( QNetworkAccessManager *manager );   // lets the benchmarks run against a stand in server
+    void setRequestBudget( std::shared_ptr< CRequestBudget > budget );   // share one budget between sync systems running at the same time
+    std::shared_ptr< CRequestBudget > requestBudget() const { return fRequestBudget; }
+    void setLibraryStructure( std::shared_ptr< CLibraryStructure > libraryStructure );   // share the item metadata between the users of a run, only the play state is requested per user
 
     void testServers( const std::vector< std::shared_ptr< const CServerInfo > > &serverInfo );
     void testServer( std::shared_ptr< const CServerInfo > serverInfo );
@@ -189,7 +257,7 @@ public:
     void setConnectedID( const QString &serverName, const QString &newID, std::shared_ptr< CUserData > &user );
     void setConnectedID( const QString &serverName, const QString &idType, const QString &newID, std::shared_ptr< CUserData > &user );
 
-    void requestGetUserAvatar( const QString &serverName, const QString &userID );
+    void requestGetUserAvatar( const QString &serverName, const QString &userID, bool useCache = true );   // the cache is keyed by the image tag the user was loaded with
     void requestSetUserAvatar( const QString &serverName, const QString &userID, const QImage &image );
 
     void updateUserDataForMedia( const QString &serverName, std::shared_ptr< CMediaData > mediaData, std::shared_ptr< SMediaServerData > newData );
@@ -221,15 +289,16 @@ private:
     bool processMedia( std::shared_ptr< CMediaData > mediaData, const QString &selectedServer );
     bool processUser( std::shared_ptr< CUserData > userData, const QString &selectedServer );
 
-    void setServerName( QNetworkReply *reply, const QString &serverName );
+    void setServerName( QNetworkRequest &request, const QString &serverName );
     QString serverName( QNetworkReply *reply );
 
-    void setRequestType( QNetworkReply *reply, ERequestType requestType );
+    void setRequestType( QNetworkRequest &request, ERequestType requestType );
     QString hostName( QNetworkReply *reply );
+    static QString hostName( const QUrl &url );
 
     ERequestType requestType( QNetworkReply *reply );
 
-    void setExtraData( QNetworkReply *reply, QVariant extraData );
+    void setExtraData( QNetworkRequest &request, QVariant extraData );
     QVariant extraData( QNetworkReply *reply );
 
 private Q_SLOTS:
@@ -244,18 +313,25 @@ private Q_SLOTS:
 
     void slotCheckPendingRequests();
     void slotRepairNextUser();
+    void slotLibraryStructureLoaded( const QString &serverName, bool aOK );
 
 private:
     QString getItemFields() const;
     std::shared_ptr< CUserData > findFirstAdminUser( std::shared_ptr< const CServerInfo > serverInfo ) const;
-    QNetworkReply *makeRequest( QNetworkRequest &request, ENetworkRequestType requestType = ENetworkRequestType::eGet, const QByteArray &data = {}, QString contentType = QString() );
+    void makeRequest( QNetworkRequest &request, ENetworkRequestType requestType = ENetworkRequestType::eGet, const QByteArray &data = {}, QString contentType = QString() );
+    QNetworkReply *sendRequest( const SPendingRequest &pendingRequest );
+    void dispatchPendingRequests();
+    void clearPendingRequests();
+    static int requestPriority( ERequestType requestType );
 
     std::shared_ptr< CUserData > loadUser( const QString &serverName, const QJsonObject &user );
 
     void postHandleRequest( QNetworkReply *reply, const QString &serverName, ERequestType requestType );
     void decRequestCount( QNetworkReply *reply, ERequestType requestType );
+    void decRequestCount( const QString &hostName, ERequestType requestType );
 
     bool isLastRequestOfType( ERequestType type ) const;
+    bool isLastMediaListRequest( const QString &host = {} ) const;   // the full, paged, delta and play state requests all load the users media, an empty host counts every server
 
     bool handleError( QNetworkReply *reply, const QString &serverName, QString &errorMsg, bool reportMsg );
     std::list< std::shared_ptr< CMediaData > > handleGetMediaListResponse( const QString &serverName, const QByteArray &data, const QString &progressTitle, const QString &logMsg, const QString &partialLogMsg );
@@ -276,16 +352,38 @@ private:
     void requestGetUser( const QString &serverName, const QString &userID );
     void handleGetUserResponse( const QString &serverName, const QByteArray &data );
 
-    void handleGetUserAvatarResponse( const QString &serverName, const QString &userID, const QByteArray &data );
+    void handleGetUserAvatarResponse( const QString &serverName, const QString &userID, const QString &imageTag, const QByteArray &data );
     void handleSetUserAvatarResponse( const QString &serverName, const QString &userID );
 
+    std::list< std::pair< QString, QString > > getMediaListQueryItems() const;
+    std::list< std::pair< QString, QString > > getMediaUserDataQueryItems() const;
     void requestGetMediaList( const QString &serverName );
+    bool requestGetMediaListPage( const QString &serverName );
 
     void handleGetMediaListResponse( const QString &serverName, const QByteArray &data );
+    void handleGetMediaListPageResponse( const QString &serverName, const QByteArray &data, int startIndex );
+
+    bool useMediaCache() const;
+    QString mediaCacheQueryKey() const;
+    void requestGetMediaListDelta( const QString &serverName );
+    void handleGetMediaListDeltaResponse( const QString &serverName, const QByteArray &data );
+    void cacheMediaArray( const QString &serverName, const QJsonArray &mediaArray );
+    void saveMediaCache();
+
+    bool useLibraryStructure() const;
+    void waitForLibraryStructure( const QString &serverName );
+    void finishLibraryStructureLoad( const QString &serverName, bool aOK );
+    void requestGetMediaUserData( const QString &serverName );
+    void handleGetMediaUserDataResponse( const QString &serverName, const QByteArray &data );
+    void loadMediaUserData( const QString &serverName, const QJsonArray &userDataItems, const QString &progressTitle );
+    void requestGetMediaListItems( const QString &serverName, const QStringList &mediaIDs );
 
     QJsonArray toItemArray( QJsonDocument &doc, const std::function< void( QJsonObject &obj ) > &onObj = {} ) const;
 
     std::list< std::shared_ptr< CMediaData > > loadMediaArray( QJsonArray &doc, const QString &serverName, const QString &progressTitle, const QString &logMsg, const QString &partialLogMsg );
+    void loadMediaArrayAsync( const QJsonArray &mediaArray, const QString &serverName, const QString &progressTitle, const QString &logMsg, const QString &partialLogMsg );
+    std::list< std::shared_ptr< CMediaData > > loadDecodedMedia( std::vector< SDecodedMedia > &decodedMedia, const QString &serverName, const QString &progressTitle );
+    void checkMediaListLoaded( const QString &serverName, const QString &host );   // call while the caller is still counted as a media list request
 
     void requestMissingTVDBid( const QString &serverName );
     void handleMissingTVDBidResponse( const QString &serverName, const QByteArray &data );
@@ -318,6 +416,13 @@ private:
 
     void handleReloadMediaResponse( const QString &serverName, const QByteArray &data, const QString &id );
 
+    void addWriteBack( const QString &serverName, const QString &mediaID, std::shared_ptr< CMediaData > mediaData, std::shared_ptr< SMediaServerData > newData );
+    const SWriteBackItem *findWriteBack( const QString &serverName, const QString &mediaID ) const;   // nullptr once the write back is finished or canceled
+    void finishWriteBack( const QString &serverName );
+    void requestVerifyUserMediaData( const QString &serverName, const QStringList &mediaIDs );
+    void handleVerifyUserMediaDataResponse( const QString &serverName, const QByteArray &data );
+    void finishVerifyUserMediaData( const QString &serverName );
+
     void requestUpdateUserData( const QString &serverName, std::shared_ptr< CUserData > userData, std::shared_ptr< SUserServerData > newData );
     void handleUpdateUserData( const QString &serverName, const QString &userID );
 
@@ -343,14 +448,29 @@ private:
 
     std::unordered_map< ERequestType, std::unordered_map< QString, int > > fRequests;   // request type -> host -> count
     std::unordered_map< QNetworkReply *, std::unordered_map< int, QVariant > > fAttributes;
+    std::map< QString, SHostRequestQueue > fHostQueues;   // host -> requests waiting for a free slot
+    std::shared_ptr< CRequestBudget > fRequestBudget;
+    bool fDispatching{ false };
 
     std::function< void( std::shared_ptr< CMediaData > mediaData ) > fProcessNewMediaFunc;
     std::function< void( EMsgType type, const QString &title, const QString &msg ) > fUserMsgFunc;
     std::shared_ptr< CProgressSystem > fProgressSystem;
+    std::shared_ptr< CMediaCache > fMediaCache;
+    CAvatarCache *fAvatarCache{ nullptr };
 
     using TOptionalBoolPair = std::pair< std::optional< bool >, std::optional< bool > >;
     std::unordered_map< QString, TOptionalBoolPair > fLeftAndRightFinished;
     std::unordered_map< QString, std::shared_ptr< const CServerInfo > > fTestServers;
+    std::unordered_map< QString, SWriteBackInfo > fWriteBacks;   // server name -> play state writes of the current sync
+    std::unordered_map< QString, SMediaPageInfo > fMediaPageInfo;   // server name -> paging state for the current media list load
+    std::unordered_map< QString, QDateTime > fMediaCacheSyncTime;   // server name -> time the current media list load started, saved with the cache
+    std::unordered_map< QString, int > fMediaDeltaRequests;   // server name -> outstanding delta requests
+    std::unique_ptr< QThreadPool > fDecodePool;
+    std::unordered_map< QString, int > fMediaDecodes;   // host -> media arrays being decoded, each is also counted as a media list request
+    int fMediaDecodeGeneration{ 0 };   // bumped on cancel, the decodes started before are dropped when they finish
+    std::shared_ptr< CLibraryStructure > fLibraryStructure;
+    std::set< QString > fLibraryStructureLoads;   // servers this sync system is loading the shared structure for
+    std::set< QString > fLibraryStructureWaits;   // servers waiting on another sync system to finish loading the structure
     std::list< SConnectIDInfo > fUsersNeedingConnectIDUpdates;
     std::pair< ETool, std::shared_ptr< CUserData > > fCurrUserData{ ETool::eNone, {} };
     SConnectIDInfo fCurrUserConnectID;
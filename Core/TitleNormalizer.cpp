@@ -0,0 +1,185 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TitleNormalizer.h"
+
+#include "SABUtils/StringUtils.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QStringList>
+
+#include <algorithm>
+#include <array>
+#include <optional>
+
+namespace
+{
+    QReadWriteLock sCacheLock;
+    QHash< QString, QString > sCurrent;
+    QHash< QString, QString > sPrevious;
+    int sCapacity{ 50000 };
+
+    const std::array< QString, 2 > sDroppedWords = { "chapter", "part" };
+    const std::array< QStringList, 3 > sDroppedPrefixes = { QStringList( { "the" } ), QStringList( { "national", "lampoons" } ), QStringList( { "monty", "pythons" } ) };
+
+    bool isWordChar( QChar ch )
+    {
+        auto unicode = ch.unicode();
+        return ( ( unicode >= 'a' ) && ( unicode <= 'z' ) ) || ( ( unicode >= '0' ) && ( unicode <= '9' ) );
+    }
+
+    bool mayBeRomanNumeral( const QString &word )
+    {
+        for ( auto &&ch : word )
+        {
+            switch ( ch.unicode() )
+            {
+                case 'i':
+                case 'v':
+                case 'x':
+                case 'l':
+                case 'c':
+                case 'd':
+                case 'm':
+                    continue;
+                default:
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // must be called with the write lock held
+    void insert( const QString &title, const QString &key )
+    {
+        if ( sCurrent.size() >= std::max( 1, sCapacity / 2 ) )
+        {
+            sPrevious = std::move( sCurrent );
+            sCurrent = QHash< QString, QString >();
+        }
+        sCurrent.insert( title, key );
+    }
+}
+
+QString CTitleNormalizer::normalize( const QString &title )
+{
+    // one pass splits the lowered title into words, only a-z and 0-9 are kept
+    QStringList words;
+    bool atStart = true;   // the dropped prefixes only count when the title starts with them
+    QString word;
+    word.reserve( title.length() );
+    auto endWord = [ &words, &word, &atStart ]()
+    {
+        if ( word.isEmpty() )
+            return;
+        if ( std::find( sDroppedWords.begin(), sDroppedWords.end(), word ) != sDroppedWords.end() )
+            atStart = atStart && !words.isEmpty();
+        else
+            words << word;
+        word.clear();
+    };
+
+    for ( int ii = 0; ii < title.length(); ++ii )
+    {
+        auto ch = title[ ii ].toLower();
+        if ( isWordChar( ch ) )
+        {
+            word += ch;
+            continue;
+        }
+
+        if ( ii == 0 )
+            atStart = false;
+        endWord();
+    }
+    endWord();
+
+    int first = 0;
+    for ( auto &&prefix : sDroppedPrefixes )
+    {
+        if ( !atStart || ( ( first + prefix.count() ) >= words.count() ) )   // a title that is only the prefix keeps it
+            break;
+
+        if ( std::equal( prefix.begin(), prefix.end(), words.begin() + first ) )
+            first += prefix.count();
+    }
+
+    QString retVal;
+    retVal.reserve( title.length() );
+    for ( int ii = first; ii < words.count(); ++ii )
+    {
+        auto curr = words[ ii ];
+        int value;
+        if ( mayBeRomanNumeral( curr ) && NSABUtils::NStringUtils::isRomanNumeral( curr, &value ) )
+            curr = QString::number( value );
+
+        if ( !retVal.isEmpty() )
+            retVal += ' ';
+        retVal += curr;
+    }
+    return retVal;
+}
+
+QString CTitleNormalizer::key( const QString &title )
+{
+    std::optional< QString > retVal;
+    {
+        QReadLocker locker( &sCacheLock );
+        auto pos = sCurrent.constFind( title );
+        if ( pos != sCurrent.constEnd() )
+            return pos.value();
+
+        pos = sPrevious.constFind( title );
+        if ( pos != sPrevious.constEnd() )
+            retVal = pos.value();
+    }
+
+    if ( !retVal.has_value() )
+        retVal = normalize( title );   // outside the lock, other threads keep reading
+
+    QWriteLocker locker( &sCacheLock );
+    if ( !sCurrent.contains( title ) )   // another thread may have added it
+        insert( title, retVal.value() );
+    return retVal.value();
+}
+
+void CTitleNormalizer::setCacheCapacity( int capacity )
+{
+    QWriteLocker locker( &sCacheLock );
+    sCapacity = capacity;
+    sCurrent.clear();
+    sPrevious.clear();
+}
+
+int CTitleNormalizer::cacheSize()
+{
+    QReadLocker locker( &sCacheLock );
+    return sCurrent.size() + sPrevious.size();
+}
+
+void CTitleNormalizer::clearCache()
+{
+    QWriteLocker locker( &sCacheLock );
+    sCurrent.clear();
+    sPrevious.clear();
+}
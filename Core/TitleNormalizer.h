@@ -0,0 +1,44 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __TITLENORMALIZER_H
+#define __TITLENORMALIZER_H
+
+#include <QString>
+
+// turns a title into the key used to match media by name
+// lower case, anything but a-z and 0-9 separates words, "chapter" and "part" are dropped, a leading "the", "national lampoons" or "monty pythons" is dropped
+// and roman numerals become numbers, so "The Godfather: Part II" and "godfather 2" share a key
+//
+// keys are cached process wide, the cache is thread safe and bounded, once the current generation fills up it becomes the previous one
+// and the old previous generation is dropped, keys still in use are promoted back into the current generation
+class CTitleNormalizer
+{
+public:
+    static QString key( const QString &title );   // thread safe
+    static QString normalize( const QString &title );   // uncached
+
+    static void setCacheCapacity( int capacity );   // the most keys held across both generations
+    static int cacheSize();
+    static void clearCache();
+};
+#endif
@@ -383,6 +383,28 @@ bool CUserData::isUser( const QString &serverName, const QString &userID ) const
     return ( *pos ).second->fUserID == userID;
 }
 
+std::map< QString, QString > CUserData::userIDs() const
+{
+    std::map< QString, QString > retVal;
+    for ( auto &&ii : fInfoForServer )
+    {
+        if ( !ii.second->fUserID.isEmpty() )
+            retVal[ ii.first ] = ii.second->fUserID;
+    }
+    return retVal;
+}
+
+QStringList CUserData::names() const
+{
+    QStringList retVal;
+    for ( auto &&ii : fInfoForServer )
+    {
+        if ( !ii.second->fName.isEmpty() && !retVal.contains( ii.second->fName ) )
+            retVal << ii.second->fName;
+    }
+    return retVal;
+}
+
 bool CUserData::connectedIDNeedsUpdate() const
 {
     return !fConnectedID.second.isEmpty() && !NSABUtils::NStringUtils::isValidEmailAddress( fConnectedID.second );
@@ -436,6 +458,7 @@ void CUserData::setAvatarInfo( const QString &serverName, const QString &tag, do
 {
     auto serverInfo = userInfo( serverName, true );
     serverInfo->fAvatarInfo = { tag, ratio, {} };
+    serverInfo->fAvatarHash.clear();
 }
 
 QImage CUserData::globalAvatar() const   // when all servers use the same image
@@ -484,7 +507,9 @@ void CUserData::checkAllAvatarsTheSame( int serverNum )
     if ( serverNum != this->fInfoForServer.size() )
         return;
 
-    fGlobalImage = allSame< QImage >( []( std::shared_ptr< SUserServerData > rhs ) { return std::get< 2 >( rhs->fAvatarInfo ); } );
+    auto sameHash = allSame< QByteArray >( []( std::shared_ptr< SUserServerData > rhs ) { return rhs->fAvatarHash; } );
+    if ( sameHash.has_value() && !sameHash.value().isEmpty() )   // no server has an avatar
+        fGlobalImage = std::get< 2 >( fInfoForServer.cbegin()->second->fAvatarInfo );
 }
 
 bool CUserData::allUserDataTheSame() const
@@ -533,7 +558,7 @@ bool CUserData::allConnectIDTypeTheSame() const
 
 bool CUserData::allIconInfoTheSame() const
 {
-    return allSame< std::pair< double, QImage > >( []( std::shared_ptr< SUserServerData > rhs ) { return std::make_pair( std::get< 1 >( rhs->fAvatarInfo ), std::get< 2 >( rhs->fAvatarInfo ) ); } ).has_value();
+    return allSame< std::pair< double, QByteArray > >( []( std::shared_ptr< SUserServerData > rhs ) { return std::make_pair( std::get< 1 >( rhs->fAvatarInfo ), rhs->fAvatarHash ); } ).has_value();
 }
 
 bool CUserData::allDateCreatedSame() const
@@ -671,12 +696,18 @@ QImage CUserData::getAvatar( const QString &serverName, bool useUnset ) const
     return retVal;
 }
 
-void CUserData::setAvatar( const QString &serverName, int serverCnt, const QImage &image )
+bool CUserData::setAvatar( const QString &serverName, int serverCnt, const QImage &image, const QByteArray &hash )
 {
     auto serverInfo = userInfo( serverName, true );
+    if ( !hash.isEmpty() && ( serverInfo->fAvatarHash == hash ) )
+        return false;
+
     std::get< 2 >( serverInfo->fAvatarInfo ) = image;
+    serverInfo->fAvatarHash = hash;
+    fGlobalImage.reset();   // the image may have changed on one server only
 
     checkAllAvatarsTheSame( serverCnt );
+    return true;
 }
 
 bool CUserData::onServer( const QString &serverName ) const
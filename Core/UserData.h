@@ -63,6 +63,8 @@ public:
     bool isUser( const QString &name ) const;
     bool isUser( const QRegularExpression &regEx ) const;
     bool isUser( const QString &serverName, const QString &userID ) const;
+    std::map< QString, QString > userIDs() const;   // serverName -> the user ID on that server
+    QStringList names() const;   // the names on each server isUser( name ) matches, without the connected ID and allNames
 
     bool connectedIDNeedsUpdate() const;
 
@@ -125,7 +127,7 @@ public:
     void setAvatarInfo( const QString &serverName, const QString &tag, double ratio );
 
     QImage getAvatar( const QString &serverName, bool useUnsetIcon = false ) const;
-    void setAvatar( const QString &serverName, int serverCnt, const QImage &image );
+    bool setAvatar( const QString &serverName, int serverCnt, const QImage &image, const QByteArray &hash );   // false when the server already has the image
     QImage anyAvatar() const;   // first avatar non-null
 
     QDateTime getDateCreated( const QString &serverName ) const;
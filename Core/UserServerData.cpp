@@ -196,7 +196,7 @@ bool SUserServerData::userDataEqual( const SUserServerData &rhs ) const
 
     // avatar infos image id is not checked
     equal = equal && std::get< 1 >( fAvatarInfo ) == std::get< 1 >( rhs.fAvatarInfo );
-    equal = equal && std::get< 2 >( fAvatarInfo ) == std::get< 2 >( rhs.fAvatarInfo );
+    equal = equal && fAvatarHash == rhs.fAvatarHash;
 
     if ( !fDateCreated.isNull() && !rhs.fDateCreated.isNull() )
         equal = equal && fDateCreated == rhs.fDateCreated;
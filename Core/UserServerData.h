@@ -46,6 +46,7 @@ struct SUserServerData
     QString fPrefix;
     bool fEnableAutoLogin{ false };
     std::tuple< QString, double, QImage > fAvatarInfo;
+    QByteArray fAvatarHash;   // content hash of the avatar image, images are compared by it
     QDateTime fDateCreated;
     QDateTime fLastLoginDate;
     QDateTime fLastActivityDate;
@@ -12,6 +12,8 @@
 #include <QJsonDocument>
 #include <QImage>
 
+#include <algorithm>
+
 CUsersModel::CUsersModel( std::shared_ptr< CSettings > settings, std::shared_ptr< CServerModel > serverModel, QObject *parent ) :
     QAbstractTableModel( parent ),
     fSettings( settings ),
@@ -546,28 +548,31 @@ QModelIndex CUsersModel::indexForUser( std::shared_ptr< CUserData > user, int co
 {
     if ( !user )
         return {};
-    for ( size_t ii = 0; ii < fUsers.size(); ++ii )
-    {
-        if ( fUsers[ ii ] == user )
-        {
-            return index( static_cast< int >( ii ), column, {} );
-        }
-    }
-    return {};
+    auto pos = fUserToRow.find( user );
+    if ( pos == fUserToRow.end() )
+        return {};
+    return index( static_cast< int >( ( *pos ).second ), column, {} );
 }
 
-void CUsersModel::setUserAvatar( const QString &serverName, const QString &userID, const QByteArray &data )
+void CUsersModel::emitUserChanged( const std::shared_ptr< CUserData > &user )
 {
-    auto image = QImage::fromData( data );
-    if ( !image.isNull() )
-    {
-        auto user = userDataOnServer( serverName, userID );
-        if ( !user )
-            return;
+    auto first = indexForUser( user, 0 );
+    if ( !first.isValid() )
+        return;
+    emit dataChanged( first, index( first.row(), columnCount() - 1 ) );
+}
 
-        user->setAvatar( serverName, fServerModel->serverCnt(), image );
-        emit dataChanged( indexForUser( user, 0 ), indexForUser( user, columnCount() - 1 ) );
-    }
+void CUsersModel::setUserAvatar( const QString &serverName, const QString &userID, const QImage &image, const QByteArray &hash )
+{
+    if ( image.isNull() )
+        return;
+
+    auto user = userDataOnServer( serverName, userID );
+    if ( !user )
+        return;
+
+    if ( user->setAvatar( serverName, fServerModel->serverCnt(), image, hash ) )
+        emitUserChanged( user );
 }
 
 void CUsersModel::updateUserConnectID( const QString &serverName, const QString &userID, const QString &idType, const QString &connectID )
@@ -577,7 +582,8 @@ void CUsersModel::updateUserConnectID( const QString &serverName, const QString
         return;
 
     user->setConnectedID( serverName, idType, connectID );
-    emit dataChanged( indexForUser( user, 0 ), indexForUser( user, columnCount() - 1 ) );
+    indexUser( user );
+    emitUserChanged( user );
 }
 
 void CUsersModel::slotSettingsChanged()
@@ -590,8 +596,13 @@ void CUsersModel::clear()
     beginResetModel();
     fUsers.clear();
     fUserMap.clear();
+    fUsersByServerID.clear();
+    fUsersByName.clear();
+    fUserToRow.clear();
+    fUserKeys.clear();
     setupColumns();
     endResetModel();
+    emit sigCleared();
 }
 
 QString CUsersModel::serverForColumn( int column ) const
@@ -640,22 +651,88 @@ std::shared_ptr< CUserData > CUsersModel::userData( int userNum ) const
 
 std::shared_ptr< CUserData > CUsersModel::userDataOnServer( const QString &serverName, const QString &userID ) const
 {
-    for ( auto &&ii : fUsers )
+    auto pos = fUsersByServerID.find( serverName );
+    if ( pos == fUsersByServerID.end() )
+        return {};
+    auto pos2 = ( *pos ).second.find( userID );
+    if ( pos2 == ( *pos ).second.end() )
+        return {};
+    return ( *pos2 ).second.front();
+}
+
+// the keys CUserData::isUser( name ) compares against
+std::shared_ptr< CUserData > CUsersModel::userDataExhaustive( const QString &name ) const
+{
+    auto pos = fUsersByName.find( name );
+    if ( pos == fUsersByName.end() )
+        return {};
+    return ( *pos ).second.front();
+}
+
+void CUsersModel::addHolder( TUserHolders &holders, const std::shared_ptr< CUserData > &user ) const
+{
+    auto row = fUserToRow.at( user );
+    auto pos = std::lower_bound( holders.begin(), holders.end(), row, [ this ]( const std::shared_ptr< CUserData > &lhs, size_t rhs ) { return fUserToRow.at( lhs ) < rhs; } );
+    holders.insert( pos, user );
+}
+
+void CUsersModel::indexUser( const std::shared_ptr< CUserData > &user )
+{
+    unindexUser( user );
+
+    SUserKeys keys;
+    keys.fUserIDs = user->userIDs();
+    keys.fNames = user->names();
+    for ( auto &&ii : { user->connectedID(), user->allNames() } )
     {
-        if ( ii->isUser( serverName, userID ) )
-            return ii;
+        if ( !ii.isEmpty() && !keys.fNames.contains( ii ) )
+            keys.fNames << ii;
     }
-    return {};
+    keys.fSortName = user->sortName( fServerModel );
+
+    for ( auto &&ii : keys.fUserIDs )
+        addHolder( fUsersByServerID[ ii.first ][ ii.second ], user );
+    for ( auto &&ii : keys.fNames )
+        addHolder( fUsersByName[ ii ], user );
+    Q_ASSERT( !keys.fSortName.isEmpty() );
+    fUserMap[ keys.fSortName ] = user;
+
+    fUserKeys[ user ] = std::move( keys );
 }
 
-std::shared_ptr< CUserData > CUsersModel::userDataExhaustive( const QString &name ) const
+void CUsersModel::unindexUser( const std::shared_ptr< CUserData > &user )
 {
-    for ( auto &&ii : fUsers )
+    auto pos = fUserKeys.find( user );
+    if ( pos == fUserKeys.end() )
+        return;
+
+    // only this user is removed from a key, the key is dropped once no user holds it
+    auto removeHolder = [ &user ]( auto &map, const QString &key )
     {
-        if ( ii->isUser( name ) )
-            return ii;
+        auto found = map.find( key );
+        if ( found == map.end() )
+            return;
+        auto &&holders = ( *found ).second;
+        holders.erase( std::remove( holders.begin(), holders.end(), user ), holders.end() );
+        if ( holders.empty() )
+            map.erase( found );
+    };
+
+    auto &&keys = ( *pos ).second;
+    for ( auto &&ii : keys.fUserIDs )
+    {
+        auto pos2 = fUsersByServerID.find( ii.first );
+        if ( pos2 != fUsersByServerID.end() )
+            removeHolder( ( *pos2 ).second, ii.second );
     }
-    return {};
+    for ( auto &&ii : keys.fNames )
+        removeHolder( fUsersByName, ii );
+
+    auto pos2 = fUserMap.find( keys.fSortName );
+    if ( ( pos2 != fUserMap.end() ) && ( ( *pos2 ).second == user ) )
+        fUserMap.erase( pos2 );
+
+    fUserKeys.erase( pos );
 }
 
 std::shared_ptr< CUserData > CUsersModel::userData( const QString &name, bool exhaustiveSearch ) const
@@ -711,15 +788,16 @@ std::shared_ptr< CUserData > CUsersModel::loadUser( const QString &serverName, c
         userData = std::make_shared< CUserData >( serverName, userObj );
 
         beginInsertRows( QModelIndex(), static_cast< int >( fUsers.size() ), static_cast< int >( fUsers.size() ) );
+        fUserToRow[ userData ] = fUsers.size();
         fUsers.push_back( userData );
-        Q_ASSERT( !userData->sortName( fServerModel ).isEmpty() );
-        fUserMap[ userData->sortName( fServerModel ) ] = userData;
+        indexUser( userData );
         endInsertRows();
     }
     else
     {
         userData->loadFromJSON( serverName, userObj );
-        emit dataChanged( indexForUser( userData, 0 ), indexForUser( userData, columnCount() - 1 ) );
+        indexUser( userData );   // the user now has an ID and name on this server, and maybe a new connected ID
+        emitUserChanged( userData );
     }
     return userData;
 }
@@ -7,6 +7,7 @@
 #include <memory>
 #include "SABUtils/HashUtils.h"
 
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -15,6 +16,7 @@ class CUserData;
 class CServerInfo;
 class CServerModel;
 class CSyncSystem;
+class QImage;
 class CUsersModel : public QAbstractTableModel, public IServerForColumn
 {
     Q_OBJECT;
@@ -95,7 +97,7 @@ public:
 
     QModelIndex indexForUser( std::shared_ptr< CUserData > user, int column = 0 ) const;
 
-    void setUserAvatar( const QString &serverName, const QString &userID, const QByteArray &data );
+    void setUserAvatar( const QString &serverName, const QString &userID, const QImage &image, const QByteArray &hash );   // hash is the content hash of image, an unchanged image emits nothing
 
     void updateUserConnectID( const QString &serverName, const QString &userID, const QString &idType, const QString &connectID );
 
@@ -126,6 +128,9 @@ public:
     iterator end() { return fUsers.end(); }
     const_iterator begin() const { return fUsers.cbegin(); }
     const_iterator end() const { return fUsers.cend(); }
+Q_SIGNALS:
+    void sigCleared();   // every user is gone, anything kept per user can go with them
+
 public Q_SLOTS:
     void slotSettingsChanged();
     void slotServerInfoChanged();
@@ -133,6 +138,19 @@ public Q_SLOTS:
 private:
     std::shared_ptr< CUserData > userDataExhaustive( const QString &name ) const;
 
+    // the keys a user was indexed under, so they can be removed after the user changed
+    struct SUserKeys
+    {
+        std::map< QString, QString > fUserIDs;   // serverName -> userID
+        QStringList fNames;   // the connected ID, the server names and allNames, what isUser( name ) compares against
+        QString fSortName;
+    };
+    using TUserHolders = std::vector< std::shared_ptr< CUserData > >;   // every user with the key, by row
+    void indexUser( const std::shared_ptr< CUserData > &user );   // (re-)indexes the current keys of the user
+    void unindexUser( const std::shared_ptr< CUserData > &user );
+    void addHolder( TUserHolders &holders, const std::shared_ptr< CUserData > &user ) const;
+    void emitUserChanged( const std::shared_ptr< CUserData > &user );
+
     int columnsPerServer() const;
     int perServerColumn( int column ) const;
 
@@ -141,8 +159,14 @@ private:
 
     QVariant getColor( const QModelIndex &index, bool background, bool missingOnly = false ) const;
 
-    std::map< QString, std::shared_ptr< CUserData > > fUserMap;
+    std::map< QString, std::shared_ptr< CUserData > > fUserMap;   // sortName -> user
     TUserDataVector fUsers;
+
+    // lookups that used to scan fUsers, a shared key returns the user with the lowest row as the scans did
+    std::unordered_map< QString, std::unordered_map< QString, TUserHolders > > fUsersByServerID;   // serverName -> userID -> users
+    std::unordered_map< QString, TUserHolders > fUsersByName;   // connected ID or name -> users
+    std::unordered_map< std::shared_ptr< CUserData >, size_t > fUserToRow;
+    std::unordered_map< std::shared_ptr< CUserData >, SUserKeys > fUserKeys;
     std::shared_ptr< CSettings > fSettings;
     std::shared_ptr< CServerModel > fServerModel;
 
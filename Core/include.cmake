@@ -25,27 +25,42 @@ set(USE_QT TRUE)
 set(FOLDER_NAME Libs)
 
 set(qtproject_SRCS
+    AvatarCache.cpp
     CollectionsModel.cpp
+    LibraryStructure.cpp
+    LogSink.cpp
+    Logging.cpp
+    MediaCache.cpp
     MediaData.cpp
     MediaServerData.cpp
     MediaModel.cpp
+    MediaNameIndex.cpp
     MovieSearchFilterModel.cpp
+    MovieListReader.cpp
     MovieStub.cpp
     MergeMedia.cpp
     ProgressSystem.cpp
+    RequestBudget.cpp
+    SeriesIndex.cpp
     SyncSystem.cpp
+    TitleNormalizer.cpp
     ServerInfo.cpp
     ServerModel.cpp
     Settings.cpp
+    StringPool.cpp
     UserData.cpp
     UserServerData.cpp
     UsersModel.cpp
 )
 
 set(qtproject_H
+    AvatarCache.h
     CollectionsModel.h
+    LibraryStructure.h
+    LogSink.h
     MediaModel.h
     MovieSearchFilterModel.h
+    RequestBudget.h
     ServerInfo.h
     SyncSystem.h
     UsersModel.h
@@ -53,12 +68,20 @@ set(qtproject_H
 )
 
 set(project_H
+    FunctionRunnable.h
+    Logging.h
+    MediaCache.h
     MediaData.h
+    MediaNameIndex.h
     MediaServerData.h
     MergeMedia.h
+    MovieListReader.h
     MovieStub.h
     ProgressSystem.h
+    SeriesIndex.h
     Settings.h
+    StringPool.h
+    TitleNormalizer.h
     UserData.h
     UserServerData.h
     IServerForColumn.h
@@ -32,6 +32,7 @@
 #include "Core/MediaModel.h"
 #include "Core/CollectionsModel.h"
 #include "Core/MediaData.h"
+#include "Core/MovieListReader.h"
 #include "Core/ProgressSystem.h"
 #include "Core/ServerInfo.h"
 #include "Core/Settings.h"
@@ -96,7 +97,7 @@ void CCollectionsManager::setupPage( std::shared_ptr< CSettings > settings, std:
 
     connect( fMediaModel.get(), &CMediaModel::sigMediaChanged, this, &CCollectionsManager::slotMediaChanged );
 
-    connect( this, &CCollectionsManager::sigModelDataChanged, fCollectionsModel.get(), &CCollectionsModel::slotMediaModelDataChanged );
+    connect( fMediaModel.get(), &CMediaModel::sigMediaChanged, fCollectionsModel.get(), &CCollectionsModel::slotMediaModelDataChanged );
 
     // new QAbstractItemModelTester( fCollections, QAbstractItemModelTester::FailureReportingMode::Fatal, this );
     // fMoviesModel->setSourceModel( fMediaModel.get() );
@@ -138,7 +139,7 @@ void CCollectionsManager::setupActions()
         fLoadCollections, &QAction::triggered,
         [ this ]()
         {
-            auto fileName = QFileDialog::getOpenFileName( this, QObject::tr( "Select File" ), QString(), QObject::tr( "Movie List File (*.json);;All Files (* *.*)" ) );
+            auto fileName = QFileDialog::getOpenFileName( this, QObject::tr( "Select File" ), QString(), NJSON::CMovieListReader::fileDialogFilter() );
             if ( fileName.isEmpty() )
                 return;
             addCollectionsFile( fileName, true );
@@ -363,13 +364,14 @@ void CCollectionsManager::addCollectionsFile( const QFileInfo &fi, bool force )
         auto movies = ii->movies();
         for ( auto &&movie : movies )
         {
-            auto currCollection = fCollectionsModel->addMovie( movie->name(), movie->year(), movie->resolution(), idx, movie->rank() );
+            auto currCollection = fCollectionsModel->addMovie( movie.name(), movie.year(), movie.resolution(), idx, movie.rank() );
             if ( currCollection->fCollection && currCollection->fCollection->isUnNamed() )
             {
                 currCollection->fCollection->setFileName( fi.absoluteFilePath() );
             }
         }
     }
+    fCollectionsModel->resolveMissingMedia();
 }
 
 void CCollectionsManager::slotCreateMissingCollections()
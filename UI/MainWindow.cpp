@@ -26,6 +26,7 @@
 #include "SettingsDlg.h"
 #include "TabUIInfo.h"
 
+#include "Core/LogSink.h"
 #include "Core/ProgressSystem.h"
 #include "Core/Settings.h"
 #include "Core/SyncSystem.h"
@@ -53,6 +54,12 @@ CMainWindow::CMainWindow( QWidget *parent ) :
 {
     fImpl->setupUi( this );
 
+    fLogSink = new CLogSink( this );
+    connect( fLogSink, &CLogSink::sigAppend, this, [ this ]( const QStringList &messages ) { fImpl->log->appendPlainText( messages.join( '\n' ) ); } );
+    connect( fLogSink, &CLogSink::sigReset, this, [ this ]( const QStringList &messages ) { fImpl->log->setPlainText( messages.join( '\n' ) ); } );
+    connect( fLogSink, &CLogSink::sigLastMessage, this, [ this ]( const QString &message ) { statusBar()->showMessage( message, 500 ); } );
+    applyLogSettings();
+
     fServerModel = std::make_shared< CServerModel >();
     connect( fServerModel.get(), &CServerModel::sigServersLoaded, this, &CMainWindow::slotServersLoaded );
     fSettings = std::make_shared< CSettings >( fServerModel );
@@ -132,9 +139,8 @@ void CMainWindow::setupProgressSystem()
             return 0;
         } );
     fProgressSystem->setSetMaximumFunc( [ this ]( int count ) { progressSetMaximum( count ); } );
-    fProgressSystem->setValueFunc( [ this ]() { return progressValue(); } );
     fProgressSystem->setSetValueFunc( [ this ]( int value ) { return progressSetValue( value ); } );
-    fProgressSystem->setIncFunc( [ this ]() { return progressIncValue(); } );
+    fProgressSystem->setIncFunc( []() { qApp->processEvents(); } );
     fProgressSystem->setResetFunc( [ this ]() { return progressReset(); } );
     fProgressSystem->setWasCanceledFunc(
         [ this ]()
@@ -164,6 +170,7 @@ CMainWindow::~CMainWindow()
     settings.setValue( "LastPage", fImpl->tabWidget->currentIndex() );
     fCurrentTabUIInfo = nullptr;
     disconnect( fImpl->tabWidget, &QTabWidget::currentChanged, this, &CMainWindow::slotCurentTabChanged );
+    fLogSink->disconnect( this );   // the sink is a child and outlives fImpl
 }
 
 void CMainWindow::showEvent( QShowEvent * /*event*/ )
@@ -206,6 +213,7 @@ void CMainWindow::slotSettings()
     settings.setKnownUsers( fUsersModel->getAllUsers( true ) );
     settings.setKnownShows( fMediaModel->getKnownShows() );
     settings.exec();
+    applyLogSettings();
     if ( fSettings->changed() )
     {
         slotSave();
@@ -282,6 +290,7 @@ void CMainWindow::reset()
 
     fUsersModel->clear();
     fSettings->reset();
+    fLogSink->clear();
     fImpl->log->clear();
 }
 
@@ -371,10 +380,15 @@ void CMainWindow::slotUpdateActions()
 
 void CMainWindow::slotAddToLog( int msgType, const QString &msg )
 {
-    auto fullMsg = createMessage( static_cast< EMsgType >( msgType ), msg );
-    qDebug() << fullMsg;
-    fImpl->log->appendPlainText( fullMsg );
-    statusBar()->showMessage( fullMsg, 500 );
+    fLogSink->addMessage( msgType, msg );
+}
+
+void CMainWindow::applyLogSettings()
+{
+    fLogSink->setMaxEntries( CSettings::logMaxLines() );
+    fImpl->log->setMaximumBlockCount( CSettings::logMaxLines() );
+    fLogSink->setMinLevel( CSettings::logLevel() );
+    fLogSink->setLogFile( CSettings::logFileName() );
 }
 
 void CMainWindow::slotAddInfoToLog( const QString &msg )
@@ -397,6 +411,7 @@ void CMainWindow::progressSetup( const QString &title )
     {
         fProgressDlg = new QProgressDialog( title, tr( "Cancel" ), 0, 0, this );
         connect( fProgressDlg, &QProgressDialog::canceled, this, &CMainWindow::sigCanceled );
+        connect( fProgressDlg, &QProgressDialog::canceled, [ this ]() { fProgressSystem->cancel(); } );
     }
     fProgressDlg->setLabelText( title );
     if ( fProgressDlg )
@@ -416,13 +431,6 @@ void CMainWindow::progressSetMaximum( int count )
     fProgressDlg->setMaximum( count );
 }
 
-int CMainWindow::progressValue() const
-{
-    if ( !fProgressDlg )
-        return 0;
-    return fProgressDlg->value();
-}
-
 void CMainWindow::progressSetValue( int value )
 {
     if ( !fProgressDlg )
@@ -432,15 +440,6 @@ void CMainWindow::progressSetValue( int value )
         fProgressDlg->open();
 }
 
-void CMainWindow::progressIncValue()
-{
-    if ( !fProgressDlg )
-        return;
-
-    fProgressDlg->setValue( progressValue() + 1 );
-    qApp->processEvents();
-}
-
 void CMainWindow::slotCurentTabChanged( int /*idx*/ )
 {
     if ( fCurrentTabUIInfo )
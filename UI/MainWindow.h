@@ -36,6 +36,7 @@ namespace NSABUtils
 }
 class CSettings;
 class QProgressDialog;
+class CLogSink;
 class CProgressSystem;
 class CUsersModel;
 class CSyncSystem;
@@ -103,9 +104,7 @@ private:
     void progressSetup( const QString &title );
 
     void progressSetMaximum( int count );
-    int progressValue() const;
     void progressSetValue( int value );
-    void progressIncValue();
     void progressReset();
 
     void loadFile( const QString &fileName );
@@ -113,6 +112,7 @@ private:
     void reset();
 
     void resetPages();
+    void applyLogSettings();
 
     std::unique_ptr< Ui::CMainWindow > fImpl;
     std::shared_ptr< CSettings > fSettings;
@@ -123,6 +123,7 @@ private:
 
     std::shared_ptr< CServerModel > fServerModel;
     std::shared_ptr< CProgressSystem > fProgressSystem;
+    CLogSink *fLogSink{ nullptr };
 
     QProgressDialog *fProgressDlg{ nullptr };
 
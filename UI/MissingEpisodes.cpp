@@ -53,6 +53,8 @@
 #include <QDesktopServices>
 #include <QStyledItemDelegate>
 
+#include <unordered_map>
+
 
 class CEditDelegate : public QStyledItemDelegate
 {
@@ -84,6 +86,10 @@ CMissingEpisodes::CMissingEpisodes( QWidget *parent ) :
     connect( fImpl->showsFilter, &QTreeWidget::itemChanged, this, &CMissingEpisodes::slotSearchByShowNameChanged );
     fImpl->showsFilter->setItemDelegate( new CEditDelegate( this ) );
 
+    fUpdateShowsFilterTimer = new QTimer( this );
+    fUpdateShowsFilterTimer->setSingleShot( true );
+    fUpdateShowsFilterTimer->setInterval( 250 );
+    connect( fUpdateShowsFilterTimer, &QTimer::timeout, this, &CMissingEpisodes::slotUpdateShowsFilter );
 
     fOrigFilter = loadShowFilter();
     slotSearchByShowNameChanged();
@@ -198,7 +204,7 @@ void CMissingEpisodes::setupPage( std::shared_ptr< CSettings > settings, std::sh
     fImpl->servers->setContextMenuPolicy( Qt::ContextMenuPolicy::CustomContextMenu );
     connect( fImpl->servers, &QTreeView::clicked, this, &CMissingEpisodes::slotCurrentServerChanged );
 
-    slotMediaChanged();
+    slotUpdateShowsFilter();
 
     connect( fMediaModel.get(), &CMediaModel::sigMediaChanged, this, &CMissingEpisodes::slotMediaChanged );
 
@@ -210,41 +216,86 @@ void CMissingEpisodes::setupPage( std::shared_ptr< CSettings > settings, std::sh
     showPrimaryServer();
 }
 
+// a reload changes the media in bursts, the shows filter is brought up to date once the burst settles
 void CMissingEpisodes::slotMediaChanged()
+{
+    if ( !fUpdateShowsFilterTimer->isActive() )
+        fUpdateShowsFilterTimer->start();
+}
+
+// the tree is diffed against the series index, the items of the shows still known keep their check state and season edits
+void CMissingEpisodes::slotUpdateShowsFilter()
 {
     if ( !fMissingMediaModel || !fMediaModel->hasMedia() )
         return;
 
-    auto selectedShows = getSelectedShows();
+    auto &&seriesIndex = fMediaModel->seriesIndex();
+    if ( fShowsFilterGeneration.has_value() && ( fShowsFilterGeneration.value() == seriesIndex.generation() ) )
+        return;
+    fShowsFilterGeneration = seriesIndex.generation();
+
+    auto showNames = seriesIndex.names();
 
-    auto showNames = fMediaModel->getKnownShows();
-    disconnect( fImpl->showsFilter, &QTreeWidget::itemChanged, this, &CMissingEpisodes::slotSearchByShowNameChanged );
+    // shows new to the tree take their filter from the saved one
+    std::unordered_map< QString, std::shared_ptr< SShowFilter > > savedFilters;
+    for ( auto &&ii : fOrigFilter )
+        savedFilters[ ii->fSeriesName ] = ii;
 
-    fImpl->showsFilter->clear();
+    fImpl->showsFilter->blockSignals( true );
 
+    bool filterChanged = false;
+    std::unordered_map< QString, QTreeWidgetItem * > existing;
+    for ( auto ii = fImpl->showsFilter->topLevelItemCount() - 1; ii >= 0; --ii )
+    {
+        auto curr = fImpl->showsFilter->topLevelItem( ii );
+        if ( showNames.find( curr->text( 0 ) ) == showNames.end() )
+        {
+            delete fImpl->showsFilter->takeTopLevelItem( ii );
+            filterChanged = true;
+            continue;
+        }
+        existing[ curr->text( 0 ) ] = curr;
+    }
 
+    // both the tree and the names are sorted, so each new show is inserted in front of the next existing one
+    int row = 0;
     for ( auto &&name : showNames )
     {
-        std::shared_ptr< SShowFilter > filterForShow;
-        for ( auto &&jj : selectedShows )
+        QTreeWidgetItem *curr = nullptr;
+        auto pos = existing.find( name );
+        if ( pos != existing.end() )
+            curr = ( *pos ).second;
+        else
         {
-            if ( jj->fSeriesName == name )
-            {
-                filterForShow = jj;
-                break;
-            }
+            auto pos2 = savedFilters.find( name );
+            auto filterForShow = ( pos2 == savedFilters.end() ) ? std::shared_ptr< SShowFilter >() : ( *pos2 ).second;
+            auto minSeason = ( filterForShow && filterForShow->fMinSeason.has_value() ) ? QString::number( filterForShow->fMinSeason.value() ) : QString();
+            auto maxSeason = ( filterForShow && filterForShow->fMaxSeason.has_value() ) ? QString::number( filterForShow->fMaxSeason.value() ) : QString();
+            bool enabled = filterForShow ? filterForShow->fEnabled : true;
+
+            curr = new QTreeWidgetItem( { name, minSeason, maxSeason } );
+            curr->setFlags( curr->flags() | Qt::ItemIsEditable );
+            curr->setCheckState( 0, enabled ? Qt::CheckState::Checked : Qt::CheckState::Unchecked );
+            fImpl->showsFilter->insertTopLevelItem( row, curr );
+            filterChanged = true;
         }
+        ++row;
+
+        auto summary = seriesIndex.summary( name );
+        if ( !summary.has_value() )
+            continue;
+        auto toolTip = tr( "%1 episodes" ).arg( summary->fEpisodeCount );
+        if ( summary->fMinSeason.has_value() )
+            toolTip += tr( ", seasons %1 to %2" ).arg( summary->fMinSeason.value() ).arg( summary->fMaxSeason.value() );
+        curr->setToolTip( 0, toolTip );
+    }
 
-        auto minSeason = ( filterForShow && filterForShow->fMinSeason.has_value() ) ? QString::number( filterForShow->fMinSeason.value() ) : QString();
-        auto maxSeason = ( filterForShow && filterForShow->fMaxSeason.has_value() ) ? QString::number( filterForShow->fMaxSeason.value() ) : QString();
-        bool enabled = filterForShow ? filterForShow->fEnabled : true;
+    fImpl->showsFilter->blockSignals( false );
+
+    if ( !filterChanged )
+        return;
 
-        auto curr = new QTreeWidgetItem( fImpl->showsFilter, { name, minSeason, maxSeason } );
-        curr->setFlags( curr->flags() | Qt::ItemIsEditable );
-        curr->setCheckState( 0, enabled ? Qt::CheckState::Checked : Qt::CheckState::Unchecked );
-    }
     fImpl->showsFilter->resizeColumnToContents( 0 );
-    connect( fImpl->showsFilter, &QTreeWidget::itemChanged, this, &CMissingEpisodes::slotSearchByShowNameChanged );
     slotSearchByShowNameChanged();
 }
 
@@ -29,9 +29,12 @@
 #include <QUrl>
 #include <list>
 #include <tuple>
+#include <cstdint>
+#include <optional>
 class QMenu;
 class QAction;
 class QToolBar;
+class QTimer;
 struct SShowFilter;
 namespace Ui
 {
@@ -96,6 +99,7 @@ private Q_SLOTS:
     void slotCurrentServerChanged( const QModelIndex &index );
     void slotMissingEpisodesLoaded();
     void slotMediaChanged();
+    void slotUpdateShowsFilter();
 
 private:
     std::list< std::shared_ptr< SShowFilter > > getSelectedShows() const;
@@ -120,5 +124,8 @@ private:
 
     CServerFilterModel *fServerFilterModel{ nullptr };
     CMediaMissingFilterModel *fMissingMediaModel{ nullptr };
+
+    QTimer *fUpdateShowsFilterTimer{ nullptr };
+    std::optional< uint64_t > fShowsFilterGeneration;   // the series index generation the shows filter was last updated to
 };
 #endif
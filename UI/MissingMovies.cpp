@@ -33,6 +33,7 @@
 #include "Core/MediaModel.h"
 #include "Core/MovieSearchFilterModel.h"
 #include "Core/MediaData.h"
+#include "Core/MovieListReader.h"
 #include "Core/ProgressSystem.h"
 #include "Core/ServerInfo.h"
 #include "Core/Settings.h"
@@ -77,7 +78,7 @@ CMissingMovies::CMissingMovies( QWidget *parent ) :
         fImpl->listFileBtn, &QToolButton::clicked,
         [ this ]()
         {
-            auto fileName = QFileDialog::getOpenFileName( this, QObject::tr( "Select File" ), QString(), QObject::tr( "Movie List File (*.json);;All Files (* *.*)" ) );
+            auto fileName = QFileDialog::getOpenFileName( this, QObject::tr( "Select File" ), QString(), NJSON::CMovieListReader::fileDialogFilter() );
             if ( fileName.isEmpty() )
                 return;
             fImpl->listFile->setText( QFileInfo( fileName ).absoluteFilePath() );
@@ -449,19 +450,20 @@ void CMissingMovies::setMovieSearchFile( const QString &fileName, bool force )
 
     fFileName.clear();
 
+    // the movies only go into the search model once the whole file has been read, a bad file leaves the model as it was
     QString msg;
-    auto collections = NJSON::CCollections::fromJSON( fileName, &msg );
-    if ( !collections.has_value() )
+    std::vector< NJSON::CMovie > movies;
+    NJSON::CMovieListReader reader( fileName );
+    if ( !reader.read( [ &movies ]( int /*collection*/, const NJSON::CMovie &movie ) { movies.push_back( movie ); }, &msg ) )
     {
         QMessageBox::critical( this, tr( "Error Reading File" ), msg );
         return;
     }
 
+    for ( auto &&movie : movies )
+        fMoviesModel->addSearchMovie( movie.name(), movie.year(), movie.resolution(), false );
+
     fFileName = fileName;
-    for ( auto &&movie : collections.value()->movies() )
-    {
-        fMoviesModel->addSearchMovie( movie->name(), movie->year(), movie->resolution(), false );
-    }
 }
 
 void CMissingMovies::slotAddMovieToSearchFor()
@@ -417,6 +417,11 @@ void CSettingsDlg::load()
     if ( maxItems < fImpl->maxItems->minimum() )
         maxItems = fImpl->maxItems->minimum();
     fImpl->maxItems->setValue( maxItems );
+    fImpl->mediaPageSize->setValue( std::max( fImpl->mediaPageSize->minimum(), fSettings->mediaPageSize() ) );
+    fImpl->mediaPagesInFlight->setValue( fSettings->mediaPagesInFlight() );
+    fImpl->maxRequestsPerServer->setValue( fSettings->maxRequestsPerServer() );
+    fImpl->cacheMedia->setChecked( fSettings->cacheMedia() );
+    fImpl->mediaCacheMaxAgeDays->setValue( fSettings->mediaCacheMaxAgeDays() );
 
     fImpl->syncAudio->setChecked( fSettings->syncAudio() );
     fImpl->syncVideo->setChecked( fSettings->syncVideo() );
@@ -438,6 +443,9 @@ void CSettingsDlg::load()
 
     fImpl->checkForLatest->setChecked( CSettings::checkForLatest() );
     fImpl->loadLastProject->setChecked( CSettings::loadLastProject() );
+    fImpl->logMaxLines->setValue( CSettings::logMaxLines() );
+    fImpl->logLevel->setCurrentIndex( CSettings::logLevel() );
+    fImpl->logFileName->setText( CSettings::logFileName() );
 }
 
 void CSettingsDlg::loadServer( QTreeWidget *serverTree, const std::shared_ptr< CServerInfo > &serverInfo )
@@ -500,6 +508,11 @@ void CSettingsDlg::save()
     fSettings->setMediaDestColor( fMediaDestColor );
     fSettings->setDataMissingColor( fDataMissingColor );
     fSettings->setMaxItems( ( fImpl->maxItems->value() == fImpl->maxItems->minimum() ) ? -1 : fImpl->maxItems->value() );
+    fSettings->setMediaPageSize( fImpl->mediaPageSize->value() );
+    fSettings->setMediaPagesInFlight( fImpl->mediaPagesInFlight->value() );
+    fSettings->setMaxRequestsPerServer( fImpl->maxRequestsPerServer->value() );
+    fSettings->setCacheMedia( fImpl->cacheMedia->isChecked() );
+    fSettings->setMediaCacheMaxAgeDays( fImpl->mediaCacheMaxAgeDays->value() );
 
     fSettings->setSyncAudio( fImpl->syncAudio->isChecked() );
     fSettings->setSyncVideo( fImpl->syncVideo->isChecked() );
@@ -515,6 +528,9 @@ void CSettingsDlg::save()
 
     CSettings::setCheckForLatest( fImpl->checkForLatest->isChecked() );
     CSettings::setLoadLastProject( fImpl->loadLastProject->isChecked() );
+    CSettings::setLogMaxLines( fImpl->logMaxLines->value() );
+    CSettings::setLogLevel( fImpl->logLevel->currentIndex() );
+    CSettings::setLogFileName( fImpl->logFileName->text() );
 }
 
 std::vector< std::shared_ptr< CServerInfo > > CSettingsDlg::getServerInfos( QTreeWidget *serverTree, bool enabledOnly ) const
@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include "UserDataWidget.h"
+#include "Core/AvatarCache.h"
 #include "Core/UserData.h"
 #include "Core/UserServerData.h"
 
@@ -201,6 +202,7 @@ std::shared_ptr< SUserServerData > CUserDataWidget::createUserData() const
     retVal->fEnableAutoLogin = fImpl->enableAutoLogin->isChecked();
     std::get< 1 >( retVal->fAvatarInfo ) = fImpl->avatarAspectRatio->value();
     std::get< 2 >( retVal->fAvatarInfo ) = fAvatar;
+    retVal->fAvatarHash = CAvatarCache::contentHash( fAvatar );
     retVal->fConnectedID.first = fImpl->connectIDType->currentText();
     retVal->fConnectedID.second = fImpl->connectID->text();
     retVal->fDateCreated = fImpl->creationDate->dateTime();
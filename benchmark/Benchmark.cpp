@@ -0,0 +1,495 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Benchmark.h"
+#include "FakeEmbyServer.h"
+
+#include "Core/CollectionsModel.h"
+#include "Core/LibraryStructure.h"
+#include "Core/MergeMedia.h"
+#include "Core/MediaData.h"
+#include "Core/MediaModel.h"
+#include "Core/ProgressSystem.h"
+#include "Core/ServerInfo.h"
+#include "Core/ServerModel.h"
+#include "Core/Settings.h"
+#include "Core/SyncSystem.h"
+#include "Core/UserData.h"
+#include "Core/UsersModel.h"
+
+#include <iostream>
+
+#include <QEventLoop>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <vector>
+
+#ifdef Q_OS_WIN
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+// counts the allocations made through operator new, Qt's own containers allocate with malloc and are not counted
+// the replacement is process wide, which is why the benchmarks are their own executable
+namespace
+{
+    std::atomic< uint64_t > sNumAllocations{ 0 };
+}
+
+void *operator new( std::size_t size )
+{
+    sNumAllocations.fetch_add( 1, std::memory_order_relaxed );
+    if ( auto ptr = std::malloc( size ? size : 1 ) )
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete( void *ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete( void *ptr, std::size_t ) noexcept
+{
+    std::free( ptr );
+}
+
+namespace NBenchmark
+{
+    qint64 peakRSS()
+    {
+#ifdef Q_OS_WIN
+        PROCESS_MEMORY_COUNTERS counters;
+        if ( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+            return -1;
+        return static_cast< qint64 >( counters.PeakWorkingSetSize );
+#else
+        struct rusage usage;
+        if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+            return -1;
+    #ifdef Q_OS_MACOS
+        return usage.ru_maxrss;
+    #else
+        return usage.ru_maxrss * 1024LL;
+    #endif
+#endif
+    }
+
+    std::shared_ptr< CServerModel > createServerModel( int numServers )
+    {
+        std::vector< std::shared_ptr< CServerInfo > > servers;
+        for ( int ii = 0; ii < numServers; ++ii )
+            servers.push_back( std::make_shared< CServerInfo >( QString( "Server%1" ).arg( ii + 1 ), QString( "http://server%1.benchmark:8096" ).arg( ii + 1 ), "benchmark", true ) );
+
+        auto retVal = std::make_shared< CServerModel >();
+        retVal->setServers( servers );
+        return retVal;
+    }
+
+    // each server has most of a shared library, a few server only items and some items with a conflicting tmdb id
+    QJsonObject mergeBenchmark( int numServers, int itemsPerServer )
+    {
+        auto serverModel = createServerModel( numServers );
+        CMergeMedia mergeMedia;
+        int serverNum = 0;
+        for ( auto &&serverInfo : *serverModel )
+        {
+            auto serverName = serverInfo->keyName();
+            serverNum++;
+            for ( int ii = 0; ii < itemsPerServer; ++ii )
+            {
+                auto titleNum = ( ( ii % 20 ) == 0 ) ? ( itemsPerServer * 2 * serverNum + ii ) : ii;
+                auto tmdbNum = ( ( ii % 10 ) == 0 ) ? ( titleNum + itemsPerServer ) : titleNum;
+
+                QJsonObject providers;
+                providers[ "Imdb" ] = QString( "tt%1" ).arg( titleNum, 7, 10, QChar( '0' ) );
+                providers[ "Tmdb" ] = QString::number( tmdbNum );
+
+                QJsonObject media;
+                media[ "Type" ] = "Movie";
+                media[ "Name" ] = QString( "Movie %1" ).arg( titleNum );
+                media[ "Id" ] = QString::number( ii );
+                media[ "ProviderIds" ] = providers;
+
+                auto mediaData = std::make_shared< CMediaData >( media, serverModel );
+                mediaData->setMediaID( serverName, media[ "Id" ].toString() );
+                mediaData->loadData( serverName, media );
+                mergeMedia.addMediaInfo( serverName, mediaData );
+            }
+        }
+
+        auto progressSystem = std::make_shared< CProgressSystem >();
+        QElapsedTimer timer;
+        timer.start();
+        mergeMedia.merge( progressSystem );
+        auto mergedMedia = mergeMedia.getMergedData( progressSystem ).first;
+        auto nsecs = timer.nsecsElapsed();
+
+        auto totalItems = static_cast< qint64 >( numServers ) * itemsPerServer;
+        QJsonObject retVal;
+        retVal[ "servers" ] = numServers;
+        retVal[ "items" ] = totalItems;
+        retVal[ "mergedItems" ] = static_cast< qint64 >( mergedMedia.size() );
+        retVal[ "msecs" ] = nsecs / 1000000.0;
+        retVal[ "nsecsPerItem" ] = static_cast< double >( nsecs ) / totalItems;
+        return retVal;
+    }
+
+    // doubles the library size each run, linear scaling shows up as a flat nsecsPerItem
+    QJsonObject runMergeBenchmark()
+    {
+        QJsonArray runs;
+        for ( auto &&itemsPerServer : { 5000, 10000, 20000, 40000 } )
+            runs.append( mergeBenchmark( 5, itemsPerServer ) );
+
+        QJsonObject retVal;
+        retVal[ "benchmark" ] = "merge";
+        retVal[ "runs" ] = runs;
+        return retVal;
+    }
+
+    // every item is on every server with the provider ids and external urls a typical library has
+    QJsonObject mediaDataBenchmark( int numServers, int numItems )
+    {
+        auto serverModel = createServerModel( numServers );
+        std::vector< std::shared_ptr< CMediaData > > items;
+        items.reserve( numItems );
+        for ( int ii = 0; ii < numItems; ++ii )
+        {
+            auto imdbID = QString( "tt%1" ).arg( ii, 7, 10, QChar( '0' ) );
+            QJsonObject providers;
+            providers[ "Imdb" ] = imdbID;
+            providers[ "Tmdb" ] = QString::number( ii );
+            providers[ "Tvdb" ] = QString::number( ii + 100000 );
+
+            QJsonArray externalUrls;
+            externalUrls.append( QJsonObject( { { "Name", "IMDb" }, { "Url", QString( "https://www.imdb.com/title/%1" ).arg( imdbID ) } } ) );
+            externalUrls.append( QJsonObject( { { "Name", "TheMovieDb" }, { "Url", QString( "https://www.themoviedb.org/movie/%1" ).arg( ii ) } } ) );
+            externalUrls.append( QJsonObject( { { "Name", "Trakt" }, { "Url", QString( "https://trakt.tv/search/imdb/%1" ).arg( imdbID ) } } ) );
+
+            QJsonObject userData;
+            userData[ "Played" ] = ( ii % 3 ) == 0;
+            userData[ "PlayCount" ] = ii % 3;
+
+            QJsonObject media;
+            media[ "Type" ] = "Movie";
+            media[ "Name" ] = QString( "Movie %1" ).arg( ii );
+            media[ "ProviderIds" ] = providers;
+            media[ "ExternalUrls" ] = externalUrls;
+            media[ "UserData" ] = userData;
+
+            auto mediaData = std::make_shared< CMediaData >( media, serverModel );
+            for ( auto &&serverInfo : *serverModel )
+            {
+                mediaData->setMediaID( serverInfo->keyName(), QString::number( ii ) );
+                mediaData->loadData( serverInfo->keyName(), media );
+            }
+            items.push_back( mediaData );
+        }
+
+        size_t totalBytes = 0;
+        for ( auto &&ii : items )
+            totalBytes += ii->memoryUsage();
+
+        // the scans the model and sync runs do for every item
+        QElapsedTimer timer;
+        timer.start();
+        int needsUpdating = 0;
+        for ( auto &&ii : items )
+        {
+            if ( ii->validUserDataEqual() )
+                continue;
+            for ( auto &&serverInfo : *serverModel )
+            {
+                if ( ii->needsUpdating( serverInfo->keyName() ) )
+                    needsUpdating++;
+            }
+        }
+        auto nsecs = timer.nsecsElapsed();
+
+        QJsonObject retVal;
+        retVal[ "servers" ] = numServers;
+        retVal[ "items" ] = numItems;
+        retVal[ "bytesPerItem" ] = static_cast< double >( totalBytes ) / numItems;
+        retVal[ "scanMsecs" ] = nsecs / 1000000.0;
+        retVal[ "scanNsecsPerItem" ] = static_cast< double >( nsecs ) / numItems;
+        retVal[ "needsUpdating" ] = needsUpdating;
+        return retVal;
+    }
+
+    QJsonObject runMediaDataBenchmark()
+    {
+        QJsonArray runs;
+        for ( auto &&numItems : { 50000, 200000 } )
+            runs.append( mediaDataBenchmark( 4, numItems ) );
+
+        QJsonObject retVal;
+        retVal[ "benchmark" ] = "mediadata";
+        retVal[ "runs" ] = runs;
+        return retVal;
+    }
+
+    // runs the event loop until one of the signals fires
+    template< typename... TSignals >
+    void waitFor( CSyncSystem *syncSystem, TSignals... signalList )
+    {
+        QEventLoop loop;
+        ( QObject::connect( syncSystem, signalList, &loop, [ &loop ]() { loop.quit(); } ), ... );
+        loop.exec();
+    }
+
+    double toMSecs( qint64 nsecs )
+    {
+        return nsecs / 1000000.0;
+    }
+
+    // the whole play state sync for every user, against an in process stand in for the servers
+    //  users      - load the users from every server
+    //  fetch      - time the stand in spent building the media responses, part of load
+    //  load       - request, parse and decode every page of media into the model
+    //  merge      - join the servers media and rebuild the model
+    //  diff       - find the media that needs updating and queue the writes
+    //  writeBack  - send the writes and verify them
+    //  parse and modelLoad replay the served media responses to split the load phase
+    QJsonObject syncBenchmark( const SFakeLibraryOptions &options )
+    {
+        auto serverModel = createServerModel( options.fNumServers );
+        auto settings = std::make_shared< CSettings >( false, serverModel );
+        settings->setCacheMedia( false );
+        auto usersModel = std::make_shared< CUsersModel >( settings, serverModel );
+        auto mediaModel = std::make_shared< CMediaModel >( settings, serverModel );
+        auto collectionsModel = std::make_shared< CCollectionsModel >( mediaModel );
+        auto syncSystem = std::make_shared< CSyncSystem >( settings, usersModel, mediaModel, collectionsModel, serverModel );
+
+        QStringList serverUrls;
+        QStringList serverNames;
+        for ( auto &&serverInfo : *serverModel )
+        {
+            serverUrls << serverInfo->url( true );
+            serverNames << serverInfo->keyName();
+        }
+        auto fakeServer = new CFakeEmbyServer( options, serverUrls );
+        syncSystem->setNetworkAccessManager( fakeServer );
+        if ( options.fShareStructure )
+            syncSystem->setLibraryStructure( std::make_shared< CLibraryStructure >() );
+
+        int numErrors = 0;
+        syncSystem->setUserMsgFunc( [ &numErrors ]( EMsgType msgType, const QString & /*title*/, const QString & /*msg*/ ) { numErrors += ( msgType == EMsgType::eError ) ? 1 : 0; } );
+
+        QElapsedTimer timer;
+        qint64 mergeStart = -1;
+        auto progressSystem = std::make_shared< CProgressSystem >();
+        progressSystem->setSetTitleFunc(
+            [ &timer, &mergeStart ]( const QString &title )
+            {
+                if ( title == QObject::tr( "Merging media data" ) )
+                    mergeStart = timer.nsecsElapsed();
+            } );
+        syncSystem->setProgressSystem( progressSystem );
+
+        timer.start();
+        syncSystem->loadUsers();
+        waitFor( syncSystem.get(), &CSyncSystem::sigLoadingUsersFinished );
+        auto usersNSecs = timer.nsecsElapsed();
+
+        QJsonArray users;
+        QJsonArray failures;   // phases that did not happen, any entry fails the run
+        if ( usersModel->getAllUsers( false ).empty() )
+            failures.append( QString( "no users were loaded" ) );
+        for ( auto &&user : usersModel->getAllUsers( false ) )
+        {
+            mediaModel->clear();
+            fakeServer->resetCounters();
+            fakeServer->setRecordMediaResponses( true );
+
+            auto allocationsStart = sNumAllocations.load();
+            mergeStart = -1;
+            timer.restart();
+            syncSystem->loadUsersMedia( ETool::ePlayState, user );
+            waitFor( syncSystem.get(), &CSyncSystem::sigUserMediaLoaded );
+            auto loadedNSecs = timer.nsecsElapsed();
+            auto loadNSecs = ( mergeStart < 0 ) ? loadedNSecs : mergeStart;
+            auto fetchNSecs = fakeServer->responseNSecs();
+            auto bytesServed = fakeServer->bytesServed();
+            auto allocationsLoaded = sNumAllocations.load();
+            fakeServer->setRecordMediaResponses( false );
+            if ( bytesServed <= 0 )
+                failures.append( QString( "no media was fetched for '%1'" ).arg( user->allNames() ) );
+            if ( mergeStart < 0 )
+                failures.append( QString( "the media of '%1' was never merged" ).arg( user->allNames() ) );
+            else if ( ( options.fNumItems > 0 ) && mediaModel->getAllMedia().empty() )
+                failures.append( QString( "the merge of '%1' has no media" ).arg( user->allNames() ) );
+
+            // sigProcessingFinished may fire from inside selectiveProcessMedia when nothing needs updating
+            bool processingFinished = false;
+            QEventLoop loop;
+            QObject::connect(
+                syncSystem.get(), &CSyncSystem::sigProcessingFinished, &loop,
+                [ &loop, &processingFinished ]()
+                {
+                    processingFinished = true;
+                    loop.quit();
+                } );
+
+            fakeServer->resetCounters();
+            timer.restart();
+            syncSystem->selectiveProcessMedia( QString() );
+            auto diffNSecs = timer.nsecsElapsed();
+            timer.restart();
+            if ( !processingFinished )
+                loop.exec();
+            auto writeBackNSecs = timer.nsecsElapsed();
+
+            // replay what was served, split into json parsing and decoding into a model
+            auto mediaResponses = fakeServer->takeMediaResponses();
+            std::list< std::pair< int, QJsonArray > > mediaArrays;
+            timer.restart();
+            for ( auto &&ii : mediaResponses )
+                mediaArrays.emplace_back( ii.first, QJsonDocument::fromJson( ii.second )[ "Items" ].toArray() );
+            auto parseNSecs = timer.nsecsElapsed();
+
+            CMediaModel replayModel( settings, serverModel );
+            timer.restart();
+            for ( auto &&ii : mediaArrays )
+            {
+                auto serverName = serverNames[ ii.first ];
+                auto decoded = CMediaModel::decodeMedia( serverName, ii.second, serverNames );
+                for ( auto &&jj : decoded )
+                    replayModel.loadMedia( serverName, jj );
+            }
+            auto modelLoadNSecs = timer.nsecsElapsed();
+
+            auto itemsLoaded = static_cast< qint64 >( options.fNumServers ) * options.fNumItems;
+            QJsonObject result;
+            result[ "user" ] = user->allNames();
+            result[ "itemsLoaded" ] = itemsLoaded;
+            result[ "mergedItems" ] = static_cast< qint64 >( mediaModel->getAllMedia().size() );
+            result[ "writes" ] = fakeServer->numWrites();
+            result[ "bytesServed" ] = bytesServed;
+            result[ "fetchMsecs" ] = toMSecs( fetchNSecs );
+            result[ "loadMsecs" ] = toMSecs( loadNSecs );
+            result[ "parseMsecs" ] = toMSecs( parseNSecs );
+            result[ "modelLoadMsecs" ] = toMSecs( modelLoadNSecs );
+            result[ "mergeMsecs" ] = toMSecs( loadedNSecs - loadNSecs );
+            result[ "diffMsecs" ] = toMSecs( diffNSecs );
+            result[ "writeBackMsecs" ] = toMSecs( writeBackNSecs );
+            result[ "allocationsPerItem" ] = static_cast< double >( allocationsLoaded - allocationsStart ) / itemsLoaded;
+            users.append( result );
+        }
+
+        QJsonObject retVal;
+        retVal[ "servers" ] = options.fNumServers;
+        retVal[ "itemsPerServer" ] = options.fNumItems;
+        retVal[ "overlap" ] = options.fOverlap;
+        retVal[ "numUsers" ] = options.fNumUsers;
+        retVal[ "diffEvery" ] = options.fDiffEvery;
+        retVal[ "shareStructure" ] = options.fShareStructure;
+        retVal[ "usersMsecs" ] = toMSecs( usersNSecs );
+        retVal[ "users" ] = users;
+        retVal[ "errors" ] = numErrors;
+        retVal[ "failures" ] = failures;
+        retVal[ "peakRSS" ] = peakRSS();
+        return retVal;
+    }
+
+    // options are key=value pairs separated by commas, servers, items, overlap, users, diffEvery and structure
+    QJsonObject runSyncBenchmark( const QString &optionsString )
+    {
+        SFakeLibraryOptions options;
+        for ( auto &&ii : optionsString.split( ',', Qt::SkipEmptyParts ) )
+        {
+            auto pos = ii.indexOf( '=' );
+            auto key = ii.left( pos ).trimmed().toLower();
+            auto value = ( pos == -1 ) ? QString() : ii.mid( pos + 1 ).trimmed();
+            if ( key == "servers" )
+                options.fNumServers = std::max( 1, value.toInt() );
+            else if ( key == "items" )
+                options.fNumItems = std::max( 0, value.toInt() );
+            else if ( key == "overlap" )
+                options.fOverlap = std::clamp( value.toDouble(), 0.0, 1.0 );
+            else if ( key == "users" )
+                options.fNumUsers = std::max( 1, value.toInt() );
+            else if ( key == "diffevery" )
+                options.fDiffEvery = std::max( 0, value.toInt() );
+            else if ( key == "structure" )
+                options.fShareStructure = ( value != "0" ) && ( value.toLower() != "false" );
+            else
+                std::cerr << "Unknown sync benchmark option '" << key.toStdString() << "' ignored\n";
+        }
+
+        QJsonObject retVal;
+        retVal[ "benchmark" ] = "sync";
+        retVal[ "runs" ] = QJsonArray( { syncBenchmark( options ) } );
+        return retVal;
+    }
+
+    QStringList availableBenchmarks()
+    {
+        return { "merge", "mediadata", "sync" };
+    }
+
+    int runBenchmark( const QString &name, const QString &options )
+    {
+        QJsonObject results;
+        if ( name == "merge" )
+            results = runMergeBenchmark();
+        else if ( name == "mediadata" )
+            results = runMediaDataBenchmark();
+        else if ( name == "sync" )
+            results = runSyncBenchmark( options );
+        else
+        {
+            std::cerr << "Unknown benchmark '" << name.toStdString() << "' valid values are " << availableBenchmarks().join( "|" ).toStdString() << "\n";
+            return -1;
+        }
+
+        std::cout << QJsonDocument( results ).toJson( QJsonDocument::Indented ).toStdString();
+
+        // a run that reported errors or skipped a phase fails, so the timings of a broken sync never pass as a result
+        int retVal = 0;
+        for ( auto &&run : results[ "runs" ].toArray() )
+        {
+            auto runObj = run.toObject();
+            if ( runObj[ "errors" ].toInt() > 0 )
+            {
+                std::cerr << "The '" << name.toStdString() << "' benchmark reported " << runObj[ "errors" ].toInt() << " errors\n";
+                retVal = 1;
+            }
+            for ( auto &&failure : runObj[ "failures" ].toArray() )
+            {
+                std::cerr << "The '" << name.toStdString() << "' benchmark failed, " << failure.toString().toStdString() << "\n";
+                retVal = 1;
+            }
+        }
+        return retVal;
+    }
+}
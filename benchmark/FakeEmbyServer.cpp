@@ -0,0 +1,296 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FakeEmbyServer.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QDateTime>
+
+#include <algorithm>
+#include <cstring>
+
+namespace NBenchmark
+{
+    constexpr int kFirstUserID = 1000;
+    constexpr int kFirstItemID = 100000;
+
+    CFakeEmbyReply::CFakeEmbyReply( QNetworkAccessManager::Operation op, const QNetworkRequest &request, const QByteArray &data, int httpStatus, QObject *parent ) :
+        QNetworkReply( parent ),
+        fData( data )
+    {
+        setRequest( request );
+        setUrl( request.url() );
+        setOperation( op );
+        setAttribute( QNetworkRequest::HttpStatusCodeAttribute, httpStatus );
+        setHeader( QNetworkRequest::ContentTypeHeader, "application/json" );
+        setHeader( QNetworkRequest::ContentLengthHeader, fData.size() );
+        if ( httpStatus >= 400 )
+            setError( QNetworkReply::ContentNotFoundError, "Not Found" );
+        open( QIODevice::ReadOnly );
+
+        // like a real reply, finish from the event loop
+        QTimer::singleShot(
+            0, this,
+            [ this ]()
+            {
+                setFinished( true );
+                emit readyRead();
+                emit finished();
+            } );
+    }
+
+    qint64 CFakeEmbyReply::bytesAvailable() const
+    {
+        return ( fData.size() - fOffset ) + QNetworkReply::bytesAvailable();
+    }
+
+    qint64 CFakeEmbyReply::readData( char *data, qint64 maxSize )
+    {
+        auto len = std::min< qint64 >( maxSize, fData.size() - fOffset );
+        if ( len <= 0 )
+            return isFinished() ? -1 : 0;
+        std::memcpy( data, fData.constData() + fOffset, len );
+        fOffset += len;
+        return len;
+    }
+
+    CFakeEmbyServer::CFakeEmbyServer( const SFakeLibraryOptions &options, const QStringList &serverUrls, QObject *parent ) :
+        QNetworkAccessManager( parent ),
+        fOptions( options )
+    {
+        for ( auto &&ii : serverUrls )
+        {
+            auto url = QUrl( ii );
+            fServers[ QString( "%1:%2" ).arg( url.host() ).arg( url.port() ) ] = static_cast< int >( fServers.size() );
+        }
+    }
+
+    void CFakeEmbyServer::resetCounters()
+    {
+        fResponseNSecs = 0;
+        fBytesServed = 0;
+        fNumRequests = 0;
+        fNumWrites = 0;
+    }
+
+    std::list< std::pair< int, QByteArray > > CFakeEmbyServer::takeMediaResponses()
+    {
+        std::list< std::pair< int, QByteArray > > retVal;
+        retVal.swap( fMediaResponses );
+        return retVal;
+    }
+
+    QNetworkReply *CFakeEmbyServer::createRequest( Operation op, const QNetworkRequest &request, QIODevice *outgoingData )
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        auto data = outgoingData ? outgoingData->readAll() : QByteArray();
+        int httpStatus = 200;
+        auto response = handleRequest( op, request.url(), data, httpStatus );
+
+        fResponseNSecs += timer.nsecsElapsed();
+        fBytesServed += response.size();
+        fNumRequests++;
+        return new CFakeEmbyReply( op, request, response, httpStatus, this );
+    }
+
+    // the paths the sync system uses
+    //   Users/Query
+    //   Users/<user>/Items                      paged with StartIndex/Limit or selected with Ids
+    //   Users/<user>/Items/<item>/UserData      POST
+    //   Users/<user>/FavoriteItems/<item>       POST/DELETE
+    QByteArray CFakeEmbyServer::handleRequest( Operation op, const QUrl &url, const QByteArray &data, int &httpStatus )
+    {
+        auto pos = fServers.find( QString( "%1:%2" ).arg( url.host() ).arg( url.port() ) );
+        auto path = url.path().split( '/', Qt::SkipEmptyParts );
+        auto usersPos = path.indexOf( "Users" );
+        if ( ( pos == fServers.end() ) || ( usersPos == -1 ) )
+        {
+            httpStatus = 404;
+            return {};
+        }
+
+        auto serverNum = ( *pos ).second;
+        path = path.mid( usersPos + 1 );
+        if ( ( path.count() == 1 ) && ( path[ 0 ] == "Query" ) )
+            return usersResponse( serverNum );
+
+        auto userNum = path.isEmpty() ? -1 : path[ 0 ].toInt() - kFirstUserID;
+        if ( ( userNum < 0 ) || ( userNum >= fOptions.fNumUsers ) || ( path.count() < 2 ) )
+        {
+            httpStatus = 404;
+            return {};
+        }
+
+        if ( ( path.count() == 2 ) && ( path[ 1 ] == "Items" ) )
+        {
+            auto retVal = itemsResponse( serverNum, userNum, url );
+            if ( fRecordMediaResponses && !QUrlQuery( url ).hasQueryItem( "Ids" ) )
+                fMediaResponses.emplace_back( serverNum, retVal );
+            return retVal;
+        }
+
+        auto itemNum = ( path.count() > 2 ) ? path[ 2 ].toInt() - kFirstItemID : -1;
+        if ( ( itemNum < 0 ) || ( itemNum >= fOptions.fNumItems ) )
+        {
+            httpStatus = 404;
+            return {};
+        }
+
+        auto key = std::make_tuple( serverNum, userNum, itemNum );
+        if ( ( path.count() == 4 ) && ( path[ 1 ] == "Items" ) && ( path[ 3 ] == "UserData" ) && ( op == PostOperation ) )
+        {
+            auto newData = QJsonDocument::fromJson( data ).object();
+            auto currData = userData( serverNum, userNum, itemNum );
+            for ( auto &&ii = newData.begin(); ii != newData.end(); ++ii )
+                currData[ ii.key() ] = ii.value();
+            fWrittenUserData[ key ] = currData;
+            fNumWrites++;
+            return QJsonDocument( currData ).toJson( QJsonDocument::Compact );
+        }
+
+        if ( ( path.count() == 3 ) && ( path[ 1 ] == "FavoriteItems" ) && ( ( op == PostOperation ) || ( op == DeleteOperation ) ) )
+        {
+            auto currData = userData( serverNum, userNum, itemNum );
+            currData[ "IsFavorite" ] = ( op == PostOperation );
+            fWrittenUserData[ key ] = currData;
+            fNumWrites++;
+            return QJsonDocument( currData ).toJson( QJsonDocument::Compact );
+        }
+
+        httpStatus = 404;
+        return {};
+    }
+
+    QByteArray CFakeEmbyServer::usersResponse( int serverNum ) const
+    {
+        QJsonArray users;
+        for ( int ii = 0; ii < fOptions.fNumUsers; ++ii )
+        {
+            QJsonObject user;
+            user[ "Name" ] = QString( "user%1" ).arg( ii + 1 );
+            user[ "Id" ] = QString::number( kFirstUserID + ii );
+            user[ "ServerId" ] = QString( "server%1" ).arg( serverNum + 1 );
+            users.append( user );
+        }
+
+        QJsonObject retVal;
+        retVal[ "Items" ] = users;
+        retVal[ "TotalRecordCount" ] = users.count();
+        return QJsonDocument( retVal ).toJson( QJsonDocument::Compact );
+    }
+
+    QByteArray CFakeEmbyServer::itemsResponse( int serverNum, int userNum, const QUrl &url ) const
+    {
+        QUrlQuery query( url );
+
+        // Fields=Id is the play state projection, only the base fields and the user data like a real server
+        auto playStateOnly = query.queryItemValue( "Fields" ) == "Id";
+        auto addItem = [ & ]( QJsonArray &items, int itemNum )
+        {
+            auto curr = item( serverNum, userNum, itemNum );
+            if ( playStateOnly )
+                curr = QJsonObject( { { "Name", curr[ "Name" ] }, { "Id", curr[ "Id" ] }, { "Type", curr[ "Type" ] }, { "UserData", curr[ "UserData" ] } } );
+            items.append( curr );
+        };
+
+        QJsonArray items;
+        if ( query.hasQueryItem( "Ids" ) )
+        {
+            for ( auto &&ii : query.queryItemValue( "Ids" ).split( ',', Qt::SkipEmptyParts ) )
+            {
+                auto itemNum = ii.toInt() - kFirstItemID;
+                if ( ( itemNum >= 0 ) && ( itemNum < fOptions.fNumItems ) )
+                    addItem( items, itemNum );
+            }
+        }
+        else
+        {
+            auto startIndex = query.hasQueryItem( "StartIndex" ) ? query.queryItemValue( "StartIndex" ).toInt() : 0;
+            auto limit = query.hasQueryItem( "Limit" ) ? query.queryItemValue( "Limit" ).toInt() : fOptions.fNumItems;
+            auto endIndex = std::min( fOptions.fNumItems, startIndex + limit );
+            for ( int ii = startIndex; ii < endIndex; ++ii )
+                addItem( items, ii );
+        }
+
+        QJsonObject retVal;
+        retVal[ "Items" ] = items;
+        retVal[ "TotalRecordCount" ] = fOptions.fNumItems;
+        return QJsonDocument( retVal ).toJson( QJsonDocument::Compact );
+    }
+
+    // the first fOverlap of every library is the same media on all servers, the rest is only on one server
+    QJsonObject CFakeEmbyServer::item( int serverNum, int userNum, int itemNum ) const
+    {
+        auto sharedItems = static_cast< int >( fOptions.fNumItems * fOptions.fOverlap );
+        auto titleNum = ( itemNum < sharedItems ) ? itemNum : ( ( serverNum + 1 ) * 10000000 + itemNum );
+        auto imdbID = QString( "tt%1" ).arg( titleNum, 8, 10, QChar( '0' ) );
+
+        QJsonObject providers;
+        providers[ "Imdb" ] = imdbID;
+        providers[ "Tmdb" ] = QString::number( titleNum );
+
+        QJsonArray externalUrls;
+        externalUrls.append( QJsonObject( { { "Name", "IMDb" }, { "Url", QString( "https://www.imdb.com/title/%1" ).arg( imdbID ) } } ) );
+
+        QJsonObject retVal;
+        retVal[ "Name" ] = QString( "Movie %1" ).arg( titleNum );
+        retVal[ "Id" ] = QString::number( kFirstItemID + itemNum );
+        retVal[ "Type" ] = "Movie";
+        retVal[ "PremiereDate" ] = QDate( 1950 + ( titleNum % 70 ), 1, 1 ).toString( Qt::ISODate );
+        retVal[ "ProviderIds" ] = providers;
+        retVal[ "ExternalUrls" ] = externalUrls;
+        retVal[ "UserData" ] = userData( serverNum, userNum, itemNum );
+        return retVal;
+    }
+
+    QJsonObject CFakeEmbyServer::userData( int serverNum, int userNum, int itemNum ) const
+    {
+        auto pos = fWrittenUserData.find( std::make_tuple( serverNum, userNum, itemNum ) );
+        if ( pos != fWrittenUserData.end() )
+            return ( *pos ).second;
+
+        // the same on every server, except every fDiffEvery item where each server has a different play state
+        auto played = ( ( itemNum + userNum ) % 5 ) == 0;
+        auto lastPlayed = QDateTime( QDate( 2022, 1, 1 ), QTime( 0, 0 ), Qt::UTC ).addSecs( 60LL * ( itemNum + userNum ) );
+        if ( ( fOptions.fDiffEvery > 0 ) && ( ( itemNum % fOptions.fDiffEvery ) == 0 ) )
+        {
+            played = ( ( itemNum + userNum + serverNum ) % 2 ) == 0;
+            lastPlayed = lastPlayed.addSecs( 3600LL * serverNum );
+        }
+
+        QJsonObject retVal;
+        retVal[ "Played" ] = played;
+        retVal[ "PlayCount" ] = played ? 1 : 0;
+        retVal[ "IsFavorite" ] = ( ( itemNum + userNum ) % 13 ) == 0;
+        retVal[ "PlaybackPositionTicks" ] = 0;
+        if ( played )
+            retVal[ "LastPlayedDate" ] = lastPlayed.toString( Qt::ISODateWithMs );
+        return retVal;
+    }
+}
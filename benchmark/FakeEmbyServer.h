@@ -0,0 +1,106 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __FAKEEMBYSERVER_H
+#define __FAKEEMBYSERVER_H
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <list>
+#include <map>
+#include <tuple>
+#include <utility>
+
+namespace NBenchmark
+{
+    // shape of the synthetic libraries served by CFakeEmbyServer
+    struct SFakeLibraryOptions
+    {
+        int fNumServers{ 2 };
+        int fNumItems{ 10000 };   // per server
+        double fOverlap{ 0.9 };   // fraction of every library with the same provider ids on all servers
+        int fNumUsers{ 1 };
+        int fDiffEvery{ 10 };   // every Nth item has a different play state on each server
+        bool fShareStructure{ true };   // only the first user loads the full items, the rest load the play state
+    };
+
+    // a finished reply holding a canned response
+    class CFakeEmbyReply : public QNetworkReply
+    {
+    public:
+        CFakeEmbyReply( QNetworkAccessManager::Operation op, const QNetworkRequest &request, const QByteArray &data, int httpStatus, QObject *parent );
+
+        void abort() override {}
+        qint64 bytesAvailable() const override;
+        bool isSequential() const override { return true; }
+
+    protected:
+        qint64 readData( char *data, qint64 maxSize ) override;
+
+    private:
+        QByteArray fData;
+        qint64 fOffset{ 0 };
+    };
+
+    // answers the Emby API calls the sync system makes without touching the network
+    // play state written by the client is remembered, so the verify requests see it
+    class CFakeEmbyServer : public QNetworkAccessManager
+    {
+    public:
+        CFakeEmbyServer( const SFakeLibraryOptions &options, const QStringList &serverUrls, QObject *parent = nullptr );
+
+        qint64 responseNSecs() const { return fResponseNSecs; }   // time spent building the responses
+        qint64 bytesServed() const { return fBytesServed; }
+        int numRequests() const { return fNumRequests; }
+        int numWrites() const { return fNumWrites; }
+        void resetCounters();
+
+        // the media list responses served since the last call, kept so the parse and model load phases can be replayed
+        void setRecordMediaResponses( bool record ) { fRecordMediaResponses = record; }
+        std::list< std::pair< int, QByteArray > > takeMediaResponses();   // server number -> response
+
+    protected:
+        QNetworkReply *createRequest( Operation op, const QNetworkRequest &request, QIODevice *outgoingData ) override;
+
+    private:
+        QByteArray handleRequest( Operation op, const QUrl &url, const QByteArray &data, int &httpStatus );
+        QByteArray usersResponse( int serverNum ) const;
+        QByteArray itemsResponse( int serverNum, int userNum, const QUrl &url ) const;
+        QJsonObject item( int serverNum, int userNum, int itemNum ) const;
+        QJsonObject userData( int serverNum, int userNum, int itemNum ) const;
+
+        SFakeLibraryOptions fOptions;
+        std::map< QString, int > fServers;   // host:port -> server number
+        std::map< std::tuple< int, int, int >, QJsonObject > fWrittenUserData;   // server, user, item -> user data written by the client
+
+        qint64 fResponseNSecs{ 0 };
+        qint64 fBytesServed{ 0 };
+        int fNumRequests{ 0 };
+        int fNumWrites{ 0 };
+        bool fRecordMediaResponses{ false };
+        std::list< std::pair< int, QByteArray > > fMediaResponses;
+    };
+}
+#endif
@@ -0,0 +1,32 @@
+set(_PROJECT_NAME EmbySyncBenchmark)
+set(USE_QT TRUE)
+set(FOLDER_NAME Tests)
+
+set(qtproject_SRCS
+    main.cpp    
+)
+
+set(project_SRCS
+    Benchmark.cpp
+    FakeEmbyServer.cpp
+)
+
+set(qtproject_H
+)
+
+set(project_H
+    Benchmark.h
+    FakeEmbyServer.h
+)
+
+set(qtproject_UIS
+)
+
+
+set(qtproject_QRC
+)
+
+set( project_pub_DEPS
+        SABUtils
+        Core
+)
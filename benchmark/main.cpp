@@ -0,0 +1,55 @@
+﻿// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Benchmark.h"
+
+#include "Version.h"
+#include <iostream>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+int main( int argc, char **argv )
+{
+    QCoreApplication appl( argc, argv );
+    NVersion::setupApplication( appl, true );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( NVersion::APP_NAME + " Benchmark - times the media loading, merging and syncing against generated libraries" );
+    parser.addHelpOption();
+
+    auto benchmarkOption = QCommandLineOption( QStringList() << "benchmark", QString( "The benchmark to run, its timings are printed as json, valid values are %1" ).arg( NBenchmark::availableBenchmarks().join( "|" ) ), "benchmark" );
+    parser.addOption( benchmarkOption );
+
+    auto benchmarkOptionsOption = QCommandLineOption( QStringList() << "benchmark_options", QString( "Comma separated key=value options for the benchmark, sync accepts servers, items, overlap, users, diffEvery and structure" ), "options" );
+    parser.addOption( benchmarkOptionsOption );
+
+    parser.process( appl );
+
+    if ( !parser.isSet( benchmarkOption ) )
+    {
+        std::cerr << "--benchmark must be set\n";
+        std::cerr << parser.helpText().toStdString() << "\n";
+        return -1;
+    }
+
+    return NBenchmark::runBenchmark( parser.value( benchmarkOption ), parser.value( benchmarkOptionsOption ) );
+}
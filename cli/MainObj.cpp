@@ -32,6 +32,7 @@
 #include "Core/ServerModel.h"
 #include "Core/CollectionsModel.h"
 #include "Core/MediaData.h"
+#include "Core/LibraryStructure.h"
 
 #include "SABUtils/QtUtils.h"
 #include "Version.h"
@@ -89,42 +90,14 @@ CMainObj::CMainObj( const QString &settingsFile, const QString &mode, QObject *p
     fCollectionsModel = std::make_shared< CCollectionsModel >( fMediaModel );
 
     fSyncSystem = std::make_shared< CSyncSystem >( fSettings, fUsersModel, fMediaModel, fCollectionsModel, fServerModel );
+    fLibraryStructure = std::make_shared< CLibraryStructure >();
 
     connect( fSyncSystem.get(), &CSyncSystem::sigAddToLog, this, &CMainObj::slotAddToLog );
     connect( fSyncSystem.get(), &CSyncSystem::sigLoadingUsersFinished, this, &CMainObj::slotLoadingUsersFinished );
-    connect( fSyncSystem.get(), &CSyncSystem::sigUserMediaLoaded, this, &CMainObj::slotProcessMedia );
     connect( fSyncSystem.get(), &CSyncSystem::sigMissingEpisodesLoaded, this, &CMainObj::slotMissingEpisodesLoaded );
 
-    connect( fSyncSystem.get(), &CSyncSystem::sigProcessingFinished, this, &CMainObj::slotProcessingFinished );
-    connect( fSyncSystem.get(), &CSyncSystem::sigUserMediaLoaded, this, &CMainObj::slotUserMediaCompletelyLoaded );
-
-    auto progressSystem = std::make_shared< CProgressSystem >();
-    progressSystem->setSetTitleFunc(
-        [ this ]( const QString &title )
-        {
-            fCurrentProgress = { 0, title, QString() };
-            addToLog( EMsgType::eInfo, std::get< 1 >( fCurrentProgress ) );
-        } );
-    progressSystem->setIncFunc(
-        [ this ]()
-        {
-            std::get< 0 >( fCurrentProgress )++;
-            static constexpr auto chars = R"(|||///---***---\\\)";
-            static auto cnt = strlen( chars );
-            auto value = std::get< 0 >( fCurrentProgress ) % cnt;
-            std::cout << chars[ value ] << '\b';
-        } );
-    progressSystem->setResetFunc(
-        [ this ]()
-        {
-            if ( std::get< 1 >( fCurrentProgress ) != std::get< 2 >( fCurrentProgress ) )
-            {
-                addToLog( EMsgType::eInfo, QString( "Finished '%1'" ).arg( std::get< 1 >( fCurrentProgress ) ) );
-                std::get< 2 >( fCurrentProgress ) = std::get< 1 >( fCurrentProgress );
-            }
-        } );
-
-    fSyncSystem->setProgressSystem( progressSystem );
+    fProgressSystem = createProgressSystem( QString() );
+    fSyncSystem->setProgressSystem( fProgressSystem );
     fSyncSystem->setUserMsgFunc( [ this ]( EMsgType msgType, const QString &title, QString msg ) { addToLog( msgType, title, msg ); } );
 
     fAOK = true;
@@ -204,6 +177,17 @@ void CMainObj::setMaximumDate( const QString &maxDate )
     }
 }
 
+void CMainObj::setMaxParallelUsers( const QString &maxParallelUsers )
+{
+    bool aOK = false;
+    fMaxParallelUsers = maxParallelUsers.toInt( &aOK );
+    if ( !aOK || ( fMaxParallelUsers < 1 ) )
+    {
+        fAOK = false;
+        fErrorString = tr( "Invalid number of parallel users '%1'." ).arg( maxParallelUsers );
+    }
+}
+
 void CMainObj::slotLoadingUsersFinished()
 {
     if ( !fSyncSystem )
@@ -271,23 +255,29 @@ void CMainObj::slotLoadingUsersFinished()
     QTimer::singleShot( 0, this, &CMainObj::slotProcessNextUser );
 }
 
+// in sync mode keeps up to fMaxParallelUsers users syncing, the shared request budget keeps the load on each server the same as a single sync
 void CMainObj::slotProcessNextUser()
 {
     if ( fUsersToSync.empty() )
     {
-        emit sigExit( 0 );
+        if ( fActiveSyncs.empty() )
+            emit sigExit( 0 );
         return;
     }
 
-    auto currUser = fUsersToSync.front();
-    fUsersToSync.pop_front();
     if ( fMode == EMode::eSync )
     {
-        slotAddToLog( EMsgType::eInfo, "Processing user: " + currUser->allNames() );
-        fSyncSystem->loadUsersMedia( ETool::ePlayState, currUser );
+        while ( !fUsersToSync.empty() && ( static_cast< int >( fActiveSyncs.size() ) < fMaxParallelUsers ) )
+        {
+            auto currUser = fUsersToSync.front();
+            fUsersToSync.pop_front();
+            startUserSync( currUser );
+        }
     }
     else if ( fMode == EMode::eCheckMissing )
     {
+        auto currUser = fUsersToSync.front();
+        fUsersToSync.pop_front();
         if ( !fSyncSystem->loadMissingEpisodes( currUser, fSelectedServer ) )
         {
             fErrorString = tr( "No user found with Administrator Privileges on server '%1'" ).arg( fSelectedServer->displayName() );
@@ -295,22 +285,80 @@ void CMainObj::slotProcessNextUser()
     }
 }
 
-void CMainObj::slotUserMediaCompletelyLoaded()
+void CMainObj::startUserSync( std::shared_ptr< CUserData > user )
 {
-    if ( fMode == EMode::eSync )
-        slotAddToLog( EMsgType::eInfo, "Finished loading media information" );
+    auto userSync = std::make_shared< SUserSync >();
+    userSync->fUser = user;
+    userSync->fMediaModel = std::make_shared< CMediaModel >( fSettings, fServerModel );
+    userSync->fCollectionsModel = std::make_shared< CCollectionsModel >( userSync->fMediaModel );
+    userSync->fSyncSystem = std::make_shared< CSyncSystem >( fSettings, fUsersModel, userSync->fMediaModel, userSync->fCollectionsModel, fServerModel );
+
+    auto syncSystem = userSync->fSyncSystem.get();
+    syncSystem->setRequestBudget( fSyncSystem->requestBudget() );
+    syncSystem->setLibraryStructure( fLibraryStructure );
+    userSync->fProgressSystem = createProgressSystem( user->allNames() );
+    syncSystem->setProgressSystem( userSync->fProgressSystem );
+    syncSystem->setUserMsgFunc( [ this ]( EMsgType msgType, const QString &title, QString msg ) { addToLog( msgType, title, msg ); } );
+
+    connect( syncSystem, &CSyncSystem::sigAddToLog, this, &CMainObj::slotAddToLog );
+    connect(
+        syncSystem, &CSyncSystem::sigUserMediaLoaded, this,
+        [ this, syncSystem, user ]()
+        {
+            slotAddToLog( EMsgType::eInfo, QString( "Finished loading media information for user '%1'" ).arg( user->allNames() ) );
+            syncSystem->selectiveProcessMedia( fSelectedServerToProcess );
+        } );
+    connect( syncSystem, &CSyncSystem::sigProcessingFinished, this, [ this, syncSystem ]( const QString &userName ) { userSyncFinished( syncSystem, userName ); } );
+
+    fActiveSyncs.push_back( userSync );
+    slotAddToLog( EMsgType::eInfo, "Processing user: " + user->allNames() );
+    syncSystem->loadUsersMedia( ETool::ePlayState, user );
 }
 
-void CMainObj::slotProcessingFinished( const QString &userName )
+// the titles are logged with the user they belong to, the counts of all the users turn the same spinner
+std::shared_ptr< CProgressSystem > CMainObj::createProgressSystem( const QString &userName )
 {
-    slotAddToLog( EMsgType::eInfo, QString( "Finished processing user '%1'" ).arg( userName ) );
-    QTimer::singleShot( 0, this, &CMainObj::slotProcessNextUser );
+    auto retVal = std::make_shared< CProgressSystem >();
+    auto currentProgress = std::make_shared< std::pair< QString, QString > >();   // current title, last finished title
+    retVal->setSetTitleFunc(
+        [ this, userName, currentProgress ]( const QString &title )
+        {
+            currentProgress->first = userName.isEmpty() ? title : QString( "%1: %2" ).arg( userName ).arg( title );
+            addToLog( EMsgType::eInfo, currentProgress->first );
+        } );
+    retVal->setIncFunc(
+        [ this ]()
+        {
+            fSpinnerPos++;
+            static constexpr auto chars = R"(|||///---***---\\\)";
+            static auto cnt = strlen( chars );
+            auto value = fSpinnerPos % cnt;
+            std::cout << chars[ value ] << '\b';
+        } );
+    retVal->setResetFunc(
+        [ this, currentProgress ]()
+        {
+            if ( currentProgress->first != currentProgress->second )
+            {
+                addToLog( EMsgType::eInfo, QString( "Finished '%1'" ).arg( currentProgress->first ) );
+                currentProgress->second = currentProgress->first;
+            }
+        } );
+    return retVal;
 }
 
-void CMainObj::slotProcessMedia()
+void CMainObj::userSyncFinished( CSyncSystem *syncSystem, const QString &userName )
 {
-    if ( fMode == EMode::eSync )
-        fSyncSystem->selectiveProcessMedia( fSelectedServerToProcess );
+    slotAddToLog( EMsgType::eInfo, QString( "Finished processing user '%1'" ).arg( userName ) );
+
+    // the sync system is still emitting, release it once control is back in the event loop
+    QTimer::singleShot(
+        0, this,
+        [ this, syncSystem ]()
+        {
+            fActiveSyncs.remove_if( [ syncSystem ]( const std::shared_ptr< SUserSync > &userSync ) { return userSync->fSyncSystem.get() == syncSystem; } );
+            slotProcessNextUser();
+        } );
 }
 
 void CMainObj::slotMissingEpisodesLoaded()
@@ -38,6 +38,19 @@ class CUsersModel;
 class CServerModel;
 class CCollectionsModel;
 class CServerInfo;
+class CProgressSystem;
+class CLibraryStructure;
+
+// one user being synced, each has its own sync system and models so several users can be synced at once
+struct SUserSync
+{
+    std::shared_ptr< CUserData > fUser;
+    std::shared_ptr< CMediaModel > fMediaModel;
+    std::shared_ptr< CCollectionsModel > fCollectionsModel;
+    std::shared_ptr< CProgressSystem > fProgressSystem;   // its own, so one users reset or cancel does not touch the others
+    std::shared_ptr< CSyncSystem > fSyncSystem;
+};
+
 class CMainObj : public QObject
 {
     Q_OBJECT;
@@ -58,6 +71,8 @@ public:
     void setMinimumDate( const QDate &minDate ) { fMinDate = minDate; }
     void setMaximumDate( const QString &maxDate );
     void setMaximumDate( const QDate &maxDate ) { fMaxDate = maxDate; }
+    void setMaxParallelUsers( const QString &maxParallelUsers );
+    void setMaxParallelUsers( int maxParallelUsers ) { fMaxParallelUsers = maxParallelUsers; }
 
     bool aOK() const;
 
@@ -73,13 +88,14 @@ public Q_SLOTS:
     void slotAddToLog( int msgType, const QString &msg );
     void slotLoadingUsersFinished();
     void slotProcessNextUser();
-    void slotUserMediaCompletelyLoaded();
-    void slotProcessingFinished( const QString &userName );
     void slotMissingEpisodesLoaded();
-    void slotProcessMedia();
 
 private:
     bool setMode( const QString &mode );
+    void startUserSync( std::shared_ptr< CUserData > user );
+    void userSyncFinished( CSyncSystem *syncSystem, const QString &userName );
+    std::shared_ptr< CProgressSystem > createProgressSystem( const QString &userName );
+
     std::shared_ptr< CSettings > fSettings;
     std::shared_ptr< CSyncSystem > fSyncSystem;
 
@@ -87,15 +103,19 @@ private:
     std::shared_ptr< CMediaModel > fMediaModel;
     std::shared_ptr< CCollectionsModel > fCollectionsModel;
     std::shared_ptr< CUsersModel > fUsersModel;
+    std::shared_ptr< CProgressSystem > fProgressSystem;
+    std::shared_ptr< CLibraryStructure > fLibraryStructure;
 
     QString fSettingsFile;
     QRegularExpression fUserRegExp;
     mutable QString fErrorString{ "Unknown Error" };
     mutable bool fAOK{ false };
 
-    std::tuple< int, QString, QString > fCurrentProgress{ 0, QString(), QString() };
+    int fSpinnerPos{ 0 };   // the progress of every sync system drives the one console spinner
 
     std::list< std::shared_ptr< CUserData > > fUsersToSync;
+    std::list< std::shared_ptr< SUserSync > > fActiveSyncs;
+    int fMaxParallelUsers{ 4 };
     QString fSelectedServerToProcess;
     std::shared_ptr< CServerInfo > fSelectedServer;
 
@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include "MainObj.h"
+#include "Core/Logging.h"
 
 #include "Version.h"
 #include <iostream>
@@ -64,12 +65,18 @@ int main( int argc, char **argv )
     auto maxDateOption = QCommandLineOption( QStringList() << "max_date", QString( "The latest premiere date to check if its missing (default %1)" ).arg( dateStr ), "max date", dateStr );
     parser.addOption( maxDateOption );
 
+    auto parallelUsersOption = QCommandLineOption( QStringList() << "parallel_users", QString( "The number of users synced at the same time, the requests to each server are still limited by MaxRequestsPerServer (default 4)" ), "count", "4" );
+    parser.addOption( parallelUsersOption );
+
     auto quietOption = QCommandLineOption(
         QStringList() << "quiet"
                       << "q",
         QString( "Minimize text output" ), "" );
     parser.addOption( quietOption );
 
+    auto captureDirOption = QCommandLineOption( QStringList() << "capture_dir", QString( "Write every server request and response to its own file in the directory, the api key is redacted" ), "capture dir" );
+    parser.addOption( captureDirOption );
+
     parser.process( appl );
 
     if ( !parser.unknownOptionNames().isEmpty() )
@@ -113,6 +120,9 @@ int main( int argc, char **argv )
         return -1;
     }
 
+    if ( parser.isSet( captureDirOption ) )
+        NLogging::setCaptureDir( parser.value( captureDirOption ) );
+
     auto settingsFile = parser.value( settingsFileOption );
     auto mainObj = std::make_shared< CMainObj >( settingsFile, mode );
     QObject::connect( mainObj.get(), &CMainObj::sigExit, &appl, &QCoreApplication::exit );
@@ -121,6 +131,7 @@ int main( int argc, char **argv )
         mainObj->setSelectiveProcesssServer( parser.value( selectedServerOption ) );
 
     mainObj->setMinimumDate( parser.value( minDateOption ) );
+    mainObj->setMaxParallelUsers( parser.value( parallelUsersOption ) );
     mainObj->setMaximumDate( parser.value( maxDateOption ) );
     mainObj->setQuiet( parser.isSet( quietOption ) );
     if ( !mainObj->aOK() )